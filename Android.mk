@@ -6,8 +6,34 @@ LOCAL_SRC_FILES:= \
 	SkiWinView.cpp \
 	SkiWinEventListener.cpp \
 	SkiWin.cpp \
+	SkiWinAnimator.cpp \
+	SkiWinEventPump.cpp \
+	SkiWinFrameExecutor.cpp \
+	SkiWinFrameStats.cpp \
+	SkiWinFramePack.cpp \
+	SkiWinImageCache.cpp \
+	SkiWinInputQueue.cpp \
+	SkiWinInputTrace.cpp \
+	SkiWinMemoryBackend.cpp \
+	SkiWinScroller.cpp \
+	SkiWinSurfaceBackend.cpp \
+	SkiWinSurfaceFlingerBackend.cpp \
+	SkiWinSurfacePool.cpp \
+	SkiWinTextLayout.cpp \
+	SkiWinTileCache.cpp \
+	SkiWinTransaction.cpp \
+	SkiWinVideoPlayer.cpp \
+	SkiWinWindowIndex.cpp \
+	SkiWinWindowManager.cpp \
 	SkiWinURLResource.cpp
 
+# the pixel conversion loops have a NEON version
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+LOCAL_SRC_FILES += SkiWinPixelConvert.cpp.neon
+else
+LOCAL_SRC_FILES += SkiWinPixelConvert.cpp
+endif
+
 LOCAL_CFLAGS += -DGL_GLEXT_PROTOTYPES -DEGL_EGLEXT_PROTOTYPES
 
 LOCAL_CFLAGS += -std=gnu++0x -Wno-non-virtual-dtor
@@ -82,3 +108,51 @@ include $(LOCAL_PATH)/SkiaSamples/samplecode_files.mk
 LOCAL_SRC_FILES += $(addprefix SkiaSamples/, $(SOURCE))
 
 include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	tools/SkiWinFramePackTool.cpp \
+	SkiWinFramePack.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	libutils \
+	libskia
+
+LOCAL_C_INCLUDES := \
+	external/skia/include/core \
+	external/skia/include/config \
+	external/skia/include/images \
+	external/skia/include \
+	$(LOCAL_PATH)
+
+LOCAL_MODULE:= skiwin-framepack
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	tools/SkiWinConvertBench.cpp
+
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+LOCAL_SRC_FILES += SkiWinPixelConvert.cpp.neon
+else
+LOCAL_SRC_FILES += SkiWinPixelConvert.cpp
+endif
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	libutils \
+	libskia
+
+LOCAL_C_INCLUDES := \
+	external/skia/include/core \
+	external/skia/include/config \
+	external/skia/include \
+	$(LOCAL_PATH)
+
+LOCAL_MODULE:= skiwin-convertbench
+
+include $(BUILD_EXECUTABLE)
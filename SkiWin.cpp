@@ -16,6 +16,7 @@
 
 #define LOG_TAG "SkiWin"
 
+#include <limits.h>
 #include <stdint.h>
 #include <sys/types.h>
 #include <math.h>
@@ -49,7 +50,6 @@
 
 #include <core/SkBitmap.h>
 #include <core/SkStream.h>
-#include <images/SkImageDecoder.h>
 #include <images/SkImageRef_GlobalPool.h>
 #include <core/SkRefCnt.h>
 #include <utils/android/AndroidKeyToSkKey.h>
@@ -66,17 +66,127 @@ extern "C" int clock_nanosleep(clockid_t clock_id, int flags,
                                const struct timespec *request,
                                struct timespec *remain);
 #define EXIT_PROP_NAME "service.skiwin.exit"
+
+// how often the exit property is polled while there is nothing to draw
+#define EXIT_POLL_INTERVAL              ms2ns(500)
+
+// playback of the /data/screenvideo frame sequence
+#define SCREEN_VIDEO_PATTERN            "/data/screenvideo/screen-%d.png"
+#define SCREEN_VIDEO_PACK               "/data/screenvideo/screen.pack"
+#define SCREEN_VIDEO_FRAME_INTERVAL     ms2ns(100)
+#define SCREEN_VIDEO_DECODERS           2
+#define SCREEN_VIDEO_DEPTH              4
+
+// byte budget of decoded images, in KB, overridable through a property
+#define IMAGE_CACHE_PROP_NAME "debug.skiwin.imagecache.kb"
+#define IMAGE_CACHE_DEFAULT_KB          2048
+
+// byte budget of shaped text, in KB, overridable through a property
+#define TEXT_LAYOUT_CACHE_PROP_NAME "debug.skiwin.textcache.kb"
+#define TEXT_LAYOUT_CACHE_DEFAULT_KB    256
+
+// set to 0 to render SampleWindows into their own bitmap and copy it
+#define DIRECT_RENDERING_PROP_NAME "debug.skiwin.direct"
+
+// bytes all view surfaces may take, in KB, views showing a SampleWindow
+// get an RGBX_8888 surface instead of 565 while they fit
+#define SURFACE_BUDGET_PROP_NAME "debug.skiwin.surface.kb"
+#define SURFACE_BUDGET_DEFAULT_KB       1024
+#define SURFACE_BUFFER_COUNT            2
+
+// set to 0 to truncate 8888 windows copied into 565 surfaces
+#define DITHER_PROP_NAME "debug.skiwin.dither"
+
+// threads helping the SkiWin thread draw views, by default one per
+// additional core up to one per view, 0 draws every view on the SkiWin
+// thread
+#define RENDER_THREADS_PROP_NAME "debug.skiwin.render.threads"
+
+// "auto" flattens the views into one surface once there are
+// FLATTEN_MIN_VIEWS of them or FLATTEN_MIN_OVERDRAW percent of the area
+// they cover would be composed more than once, 1 always does, 0 never
+#define FLATTEN_PROP_NAME "debug.skiwin.flatten"
+#define FLATTEN_MIN_VIEWS               4
+#define FLATTEN_MIN_OVERDRAW            25
+#define FLAT_VIEW_LAYER                 0x4fffffff
+
+// window animations, stepped on their own frame clock
+#define ANIMATION_FRAME_INTERVAL        ms2ns(16)
+#define HIDE_DURATION                   ms2ns(200)
+#define SHOW_DURATION                   ms2ns(250)
+#define HIDE_SCALE                      0.9f
+
+// the page in the middle view is rendered in tiles, kept within a byte
+// budget in KB overridable through a property, and rendered a few per
+// frame ahead of a scroll
+#define PAGE_TILE_CACHE_PROP_NAME "debug.skiwin.tilecache.kb"
+#define PAGE_TILE_CACHE_DEFAULT_KB      1024
+#define PAGE_TILE_SIZE                  128
+#define PAGE_PREFETCH_TILES             3
+#define PAGE_MARGIN                     20
+
+// input events the reader thread may get ahead of the SkiWin thread
+#define INPUT_QUEUE_SIZE                256
+
+// bytes the surfaces of closed windows may keep, in KB, for windows opened
+// later to reuse
+#define SURFACE_POOL_PROP_NAME "debug.skiwin.pool.kb"
+#define SURFACE_POOL_DEFAULT_KB         512
+
 namespace android
 {
 
-SkiWin::SkiWin() : Thread(false)
+/**
+ * choosePixelFormat - Pick the surface format of a view within a budget.
+ *
+ * SampleWindows render in 8888, showing them on an 8888 surface needs no
+ * conversion at all. Everything else, and SampleWindows once the budget
+ * is spent, gets 565. The bytes taken are subtracted from the budget.
+ */
+
+static PixelFormat choosePixelFormat(int w, int h, bool trueColor,
+                                     ssize_t* budget)
+    {
+    ssize_t size = ssize_t(w) * h * SURFACE_BUFFER_COUNT;
+
+    if (trueColor && *budget >= size * 4)
+        {
+        *budget -= size * 4;
+        return PIXEL_FORMAT_RGBX_8888;
+        }
+
+    *budget -= size * 2;
+    return PIXEL_FORMAT_RGB_565;
+    }
+
+SkiWin::SkiWin() : Thread(false), mImageCache(IMAGE_CACHE_DEFAULT_KB * 1024),
+    mTextLayoutCache(TEXT_LAYOUT_CACHE_DEFAULT_KB * 1024),
+    mPageTiles(PAGE_TILE_SIZE, PAGE_TILE_CACHE_DEFAULT_KB * 1024),
+    mPageScroller(ANIMATION_FRAME_INTERVAL),
+    mInputQueue(INPUT_QUEUE_SIZE)
     {
-    DisplayInfo dinfo;
+    char value[PROPERTY_VALUE_MAX];
+
+    if (property_get(IMAGE_CACHE_PROP_NAME, value, NULL) > 0)
+        mImageCache.setBudget(atoi(value) * 1024);
+
+    if (property_get(TEXT_LAYOUT_CACHE_PROP_NAME, value, NULL) > 0)
+        mTextLayoutCache.setBudget(atoi(value) * 1024);
+
+    if (property_get(PAGE_TILE_CACHE_PROP_NAME, value, NULL) > 0)
+        mPageTiles.setBudget(atoi(value) * 1024);
 
-    sp<IBinder> dtoken(SurfaceComposerClient::getBuiltInDisplay(
-                           ISurfaceComposer::eDisplayIdMain));
+    // SurfaceFlinger, or memory when running without a display
+    mBackend = SkiWinSurfaceBackend::create();
 
-    status_t status = SurfaceComposerClient::getDisplayInfo(dtoken, &dinfo);
+    if (mBackend == NULL)
+        {
+        printf("no surface backend in %s\n", __PRETTY_FUNCTION__);
+
+        return;
+        }
+
+    status_t status = mBackend->getDisplaySize(&mWidth, &mHeight);
 
     if (status)
         {
@@ -85,12 +195,20 @@ SkiWin::SkiWin() : Thread(false)
         return;
         }
 
-    mWidth = dinfo.w;
-    mHeight = dinfo.h;
-
     mFocusView = NULL;
 
-    mSession = new SurfaceComposerClient();
+    size_t poolBudget = SURFACE_POOL_DEFAULT_KB * 1024;
+
+    if (property_get(SURFACE_POOL_PROP_NAME, value, NULL) > 0)
+        poolBudget = atoi(value) * 1024;
+
+    mWindowManager = new SkiWinWindowManager(mBackend, poolBudget);
+    mAnimator = new SkiWinAnimator(mBackend, ANIMATION_FRAME_INTERVAL);
+
+    ssize_t budget = SURFACE_BUDGET_DEFAULT_KB * 1024;
+
+    if (property_get(SURFACE_BUDGET_PROP_NAME, value, NULL) > 0)
+        budget = atoi(value) * 1024;
 
     /*
     |----------------------|
@@ -110,25 +228,25 @@ SkiWin::SkiWin() : Thread(false)
     |-----|----------------|
       70         250
     */
-    mTitleViewTop = new SkiWinView(mSession,
-                                   String8("TitleViewTop"),
-                                   0, 0, 320, 30, 0x40000000);
+    mTitleViewTop = mWindowManager->createWindow(
+        String8("TitleViewTop"), 0, 0, 320, 30, 0x40000000,
+        choosePixelFormat(320, 30, false, &budget));
 
-    mContentViewTop = new SkiWinView(mSession,
-                                     String8("ContentViewTop"),
-                                     0, 30, 320, 150, 0x40000001);
+    mContentViewTop = mWindowManager->createWindow(
+        String8("ContentViewTop"), 0, 30, 320, 150, 0x40000001,
+        choosePixelFormat(320, 150, true, &budget));
 
-    mContentViewMid = new SkiWinView(mSession,
-                                     String8("ContentViewMid"),
-                                     0, 180, 320, 150, 0x40000002);
+    mContentViewMid = mWindowManager->createWindow(
+        String8("ContentViewMid"), 0, 180, 320, 150, 0x40000002,
+        choosePixelFormat(320, 150, false, &budget));
 
-    mContentViewBot = new SkiWinView(mSession,
-                                     String8("ContentViewBot"),
-                                     70, 330, 250, 150, 0x40000003);
+    mContentViewBot = mWindowManager->createWindow(
+        String8("ContentViewBot"), 70, 330, 250, 150, 0x40000003,
+        choosePixelFormat(250, 150, true, &budget));
 
-    mTitleViewBot = new SkiWinView(mSession,
-                                   String8("TitleViewBot"),
-                                   0, 330, 70, 150, 0x40000003);
+    mTitleViewBot = mWindowManager->createWindow(
+        String8("TitleViewBot"), 0, 330, 70, 150, 0x40000003,
+        choosePixelFormat(70, 150, false, &budget));
 
     application_init();
 
@@ -141,22 +259,85 @@ SkiWin::SkiWin() : Thread(false)
     mContentViewTop->setContext(reinterpret_cast<void *>(mWindowTop));
     mContentViewMid->setContext(reinterpret_cast<void *>(mWindowMid));
     mContentViewBot->setContext(reinterpret_cast<void *>(mWindowBot));
+
+    // the top window is shown 30 pixels down into its content view
+    mContentViewTop->setContentOffset(0, 30);
+
+    // only the windows showing a SampleWindow take input
+    mContentViewTop->setFocusable(true);
+    mContentViewBot->setFocusable(true);
+
+    // these paint their whole background, lockCanvas need not clear them
+    mTitleViewTop->setOpaque(true);
+    mContentViewMid->setOpaque(true);
+
+    property_get(DIRECT_RENDERING_PROP_NAME, value, "1");
+    mContentViewTop->setDirectRendering(atoi(value) != 0);
+    mContentViewBot->setDirectRendering(atoi(value) != 0);
+
+    property_get(DITHER_PROP_NAME, value, "1");
+    mContentViewTop->setDither(atoi(value) != 0);
+    mContentViewBot->setDither(atoi(value) != 0);
+
+    property_get(FLATTEN_PROP_NAME, value, "auto");
+
+    if (strcmp(value, "auto") == 0)
+        mFlattenMode = FLATTEN_AUTO;
+    else if (atoi(value) != 0)
+        mFlattenMode = FLATTEN_ALWAYS;
+    else
+        mFlattenMode = FLATTEN_NEVER;
+
+    mFlattened = false;
+    mFlatReleasePending = false;
+
+    mFramePending = 1;
+    mShowRequested = 0;
+
+    mPageBuf = NULL;
+    mPageBufLen = 0;
+    mPageHeight = 0;
+    mPageScroll = 0;
+    mPageDragging = false;
+    mPageDragPointer = -1;
+    mInputLost = 0;
+    mInputMoves = 0;
+    mInputMoveDispatches = 0;
+    mLogoBuf = NULL;
+    mLogoBufLen = 0;
+
+    mVideoSource = NULL;
     }
 
 SkiWin::~SkiWin()
     {
-    mSession = NULL;
     mTitleViewTop = NULL;
     mContentViewTop = NULL;
     mContentViewMid = NULL;
     mContentViewBot = NULL;
+    mTitleViewBot = NULL;
+    mFlatView = NULL;
+    mFlatWindows.clear();
+    mAnimator = NULL;
+    mWindowManager = NULL;
+    mBackend = NULL;
+
+    // frames may point into the source, drop them first
+    mVideoFrame.reset();
+
+    if (mVideoSource != NULL)
+        mVideoSource->stop();
+    mVideoSource = NULL;
     }
 
 void SkiWin::onFirstRef()
     {
-    status_t err = mSession->linkToComposerDeath(this);
+    if (mBackend == NULL)
+        return;
+
+    status_t err = mBackend->linkToDeath(this);
 
-    ALOGE_IF(err, "linkToComposerDeath failed (%s) ", strerror(-err));
+    ALOGE_IF(err, "linkToDeath failed (%s) ", strerror(-err));
 
     if (err == NO_ERROR)
         {
@@ -178,94 +359,78 @@ void SkiWin::binderDied(const wp<IBinder>& who)
     requestExit();
     }
 
+/*
+ * The input reader thread only queues the events, the SkiWin thread
+ * dispatches them to the windows it draws, see dispatchInput().
+ */
+
 void SkiWinNotifyKeyCallback(const NotifyKeyArgs* args, void* context)
     {
-#if 0
-    ALOGD("notifyKey - eventTime=%lld, deviceId=%d, source=0x%x, policyFlags=0x%x, action=0x%x, "
-          "flags=0x%x, keyCode=0x%x, scanCode=0x%x, metaState=0x%x, downTime=%lld",
-          args->eventTime, args->deviceId, args->source, args->policyFlags,
-          args->action, args->flags, args->keyCode, args->scanCode,
-          args->metaState, args->downTime);
-#endif
     SkiWin* skiwin = reinterpret_cast<SkiWin*>(context);
-    SkOSWindow* mFocusWindow = NULL;
-    sp<SkiWinView> mFocusView = NULL;
-#if 1
-    printf("KeyCallback args->action %d %d\n",
-           args->action, AndroidKeycodeToSkKey(args->keyCode));
-#endif
-
-    mFocusView = skiwin->getFocusView();
+    SkiWinInputEvent event;
 
-    if (AKEYCODE_HOME == args->keyCode)
-        {
-        ALOGD("============@@@@@@@@@@@@@@@@@@@AKEYCODE_HOME pressed, hiding!\n");
-        skiwin->hide();
-        }
-    else if (AKEYCODE_BACK == args->keyCode)
-        {
-        ALOGD("============@@@@@@@@@@@@@@@@@@@AKEYCODE_BACK pressed, exiting!\n");
-        exit(0);
-        }
-    
-    if (mFocusView != NULL)
-        {
-        mFocusWindow = reinterpret_cast<SkOSWindow*>(mFocusView->getContext());
+    event.type = SkiWinInputEvent::TYPE_KEY;
+    event.action = args->action;
+    event.keyCode = args->keyCode;
+    event.x = 0;
+    event.y = 0;
+    event.eventTime = args->eventTime;
+    event.pointerCount = 0;
 
-        if (mFocusWindow != NULL)
-            {
-            if (args->action == AKEY_EVENT_ACTION_DOWN)
-                {
-                mFocusWindow->handleKey(AndroidKeycodeToSkKey(args->keyCode));
-                /* mFocusWindow->handleChar((SkUnichar) uni); */
-                }
-            else if (args->action == AKEY_EVENT_ACTION_UP)
-                {
-                mFocusWindow->handleKeyUp(AndroidKeycodeToSkKey(args->keyCode));
-                }
-            }
-        }
+    skiwin->queueInput(event);
     }
 
 void SkiWinNotifyMotionCallback(const NotifyMotionArgs* args, void* context)
     {
-    int32_t x = int32_t(args->pointerCoords[0].getAxisValue(AMOTION_EVENT_AXIS_X));
-    int32_t y = int32_t(args->pointerCoords[0].getAxisValue(AMOTION_EVENT_AXIS_Y));
     SkiWin* skiwin = reinterpret_cast<SkiWin*>(context);
-    SkOSWindow* mFocusWindow = NULL;
-    sp<SkiWinView> mFocusView = NULL;
-    int32_t x0, y0;
-
-    SkView::Click::State state;
+    SkiWinInputEvent event;
+    uint32_t count;
 
-    switch(args->action)
+    switch (args->action & AMOTION_EVENT_ACTION_MASK)
         {
-        case AMOTION_EVENT_ACTION_DOWN:       // MotionEvent.ACTION_DOWN
-            state = SkView::Click::kDown_State;
-            break;
-        case AMOTION_EVENT_ACTION_UP:       // MotionEvent.ACTION_UP
-        case AMOTION_EVENT_ACTION_CANCEL:  // MotionEvent.ACTION_CANCEL
-            state = SkView::Click::kUp_State;
-            break;
-        case AMOTION_EVENT_ACTION_MOVE:       // MotionEvent.ACTION_MOVE
-            state = SkView::Click::kMoved_State;
+        case AMOTION_EVENT_ACTION_DOWN:
+        case AMOTION_EVENT_ACTION_UP:
+        case AMOTION_EVENT_ACTION_CANCEL:
+        case AMOTION_EVENT_ACTION_MOVE:
+        case AMOTION_EVENT_ACTION_POINTER_DOWN:
+        case AMOTION_EVENT_ACTION_POINTER_UP:
             break;
         default:
             SkDebugf("motion event ignored\n");
             return;
         }
 
-    mFocusView = skiwin->updateFocusView (x, y);
-
-    if (mFocusView != NULL)
+    // pointers past the ones kept are dropped, with their downs and ups
+    count = args->pointerCount;
+    if (count > SkiWinInputEvent::MAX_POINTERS)
         {
-        mFocusWindow = reinterpret_cast<SkOSWindow*>(mFocusView->getContext());
+        if (((args->action & AMOTION_EVENT_ACTION_POINTER_INDEX_MASK) >>
+             AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT) >=
+            SkiWinInputEvent::MAX_POINTERS)
+            return;
+
+        count = SkiWinInputEvent::MAX_POINTERS;
+        }
+
+    event.type = SkiWinInputEvent::TYPE_MOTION;
+    event.action = args->action;
+    event.keyCode = 0;
+    event.eventTime = args->eventTime;
+    event.pointerCount = count;
 
-        mFocusView->screenToViewSpace(x, y, &x0, &y0);
+    for (uint32_t i = 0; i < count; i++)
+        {
+        const PointerCoords& coords = args->pointerCoords[i];
 
-        if (mFocusWindow != NULL)
-            mFocusWindow->handleClick(x0, y0, state);
+        event.pointerIds[i] = args->pointerProperties[i].id;
+        event.pointerX[i] = int32_t(coords.getAxisValue(AMOTION_EVENT_AXIS_X));
+        event.pointerY[i] = int32_t(coords.getAxisValue(AMOTION_EVENT_AXIS_Y));
         }
+
+    event.x = event.pointerX[0];
+    event.y = event.pointerY[0];
+
+    skiwin->queueInput(event);
     }
 
 void SkiWinNotifySwitchCallback(const NotifySwitchArgs* args, void* context)
@@ -275,8 +440,15 @@ void SkiWinNotifySwitchCallback(const NotifySwitchArgs* args, void* context)
     printf("%s\n", __PRETTY_FUNCTION__);
     }
 
+bool SkiWinInputQueueFullCallback(void* context)
+    {
+    SkiWin* skiwin = reinterpret_cast<SkiWin*>(context);
+
+    return skiwin->isInputQueueFull();
+    }
+
 SkiWinEventCallback gInputEventCallback;
-SkiWin * gSkiWin;
+SkiWin * gSkiWin = NULL;
 
 void sessionHandler (int signum) 
     {
@@ -285,7 +457,11 @@ void sessionHandler (int signum)
     if (signum == SIGCONT)
         {
         if (gSkiWin)
-            gSkiWin->show();
+            gSkiWin->requestShow();
+        }
+    else if (signum == SIGUSR1)
+        {
+        SkiWinFrameStats::get()->requestDump();
         }
     }
 
@@ -294,8 +470,11 @@ status_t SkiWin::readyToRun()
     gInputEventCallback.pfNotifyKey = SkiWinNotifyKeyCallback;
     gInputEventCallback.pfNotifyMotion = SkiWinNotifyMotionCallback;
     gInputEventCallback.pfNotifySwitch = SkiWinNotifySwitchCallback;
+    gInputEventCallback.pfInputQueueFull = SkiWinInputQueueFullCallback;
     gInputEventCallback.context = this;
 
+    gSkiWin = this;
+
     SkiWinInputConfiguration config =
         {
         touchPointerVisible : true,
@@ -304,11 +483,12 @@ status_t SkiWin::readyToRun()
 
     SkiWinInputManagerInit(&gInputEventCallback, &config);
     SkiWinInputManagerStart();
-
-    gSkiWin = this;
     
     // Register signal and signal handler
     signal(SIGCONT, sessionHandler);
+    signal(SIGUSR1, sessionHandler);
+
+    SkiWinFrameStats::get()->startDumpServer();
     
     return NO_ERROR;
     }
@@ -335,19 +515,12 @@ static const char gText[] =
     "a decent respect to the opinions of mankind requires that they should "
     "declare the causes which impel them to the separation.";
 
-void SkiWin::drawImage(SkCanvas* canvas, const void* buffer, size_t size)
+void SkiWin::drawImage(SkCanvas* canvas, const SkBitmap& bitmap)
     {
-    SkBitmap bitmap;
     SkPaint paint;
     SkRect r;
     SkMatrix m;
 
-    SkImageDecoder::DecodeMemory(buffer, size, &bitmap);
-    if (!bitmap.pixelRef())
-        {
-        return;
-        }
-
     SkShader* s = SkShader::CreateBitmapShader(bitmap,
                   SkShader::kRepeat_TileMode,
                   SkShader::kRepeat_TileMode);
@@ -364,280 +537,1625 @@ void SkiWin::drawImage(SkCanvas* canvas, const void* buffer, size_t size)
     canvas->drawBitmap(bitmap, 0, 0, &paint);
     }
 
-void SkiWin::drawText(SkCanvas* canvas,
-                      SkScalar w, SkScalar h,
-                      SkColor fg, SkColor bg,
-                      const char text[])
+static void setupPagePaint(SkPaint* paint, SkScalar textSize)
+    {
+    paint->setAntiAlias(true);
+    paint->setLCDRenderText(true);
+    paint->setColor(SK_ColorBLACK);
+    paint->setTextSize(textSize);
+    }
+
+/**
+ * layoutPage - Lay out all of the page, for the middle view to scroll.
+ *
+ * The page is shown in a run of text sizes, one after the other, each
+ * broken into lines as wide as the view less its margins. Every line is
+ * kept, the page is as tall as the text is.
+ */
+
+void SkiWin::layoutPage()
+    {
+    SkIRect bounds = mContentViewMid->getBounds();
+    SkScalar margin = SkIntToScalar(PAGE_MARGIN);
+    SkScalar width = SkIntToScalar(bounds.width()) - 2 * margin;
+    SkScalar top = margin;
+    size_t len = strlen(mPageBuf);
+
+    mPageBlocks.clear();
+
+    for (int i = 9; i < 24; i += 2)
+        {
+        PageBlock block;
+        SkPaint paint;
+
+        setupPagePaint(&paint, SkIntToScalar(i));
+
+        block.layout = new SkiWinTextLayout();
+        block.layout->layout(mPageBuf, len, paint, width, 0,
+                             SkIntToScalar(3)/3, 0);
+        block.textSize = paint.getTextSize();
+        block.top = top;
+
+        mPageBlocks.add(block);
+
+        top += block.layout->getTextHeight() + paint.getFontSpacing();
+        }
+
+    mPageHeight = SkScalarCeil(top);
+
+    SkBitmap::Config config =
+        mContentViewMid->getPixelFormat() == PIXEL_FORMAT_RGB_565 ?
+        SkBitmap::kRGB_565_Config : SkBitmap::kARGB_8888_Config;
+
+    mPageTiles.setContent(bounds.width(), mPageHeight, config,
+                          drawPageTile, this);
+    mPageScroller.setRange(mPageHeight - bounds.height());
+    }
+
+/**
+ * drawPageTile - Render the part of the page in area into a tile.
+ */
+
+void SkiWin::drawPageTile(void* context, SkCanvas* canvas,
+                          const SkIRect& area)
     {
-    SkAutoCanvasRestore acr(canvas, true);
+    SkiWin* skiwin = reinterpret_cast<SkiWin*>(context);
+    SkScalar margin = SkIntToScalar(PAGE_MARGIN);
+
+    canvas->drawColor(SK_ColorWHITE);
+    canvas->translate(SkIntToScalar(-area.fLeft), SkIntToScalar(-area.fTop));
+
+    for (size_t i = 0; i < skiwin->mPageBlocks.size(); i++)
+        {
+        const PageBlock& block = skiwin->mPageBlocks[i];
+        SkPaint paint;
 
-    canvas->clipRect(SkRect::MakeWH(w, h));
-    canvas->drawColor(bg);
-    SkScalar margin = 20;
-    SkTextBox tbox;
-    tbox.setMode(SkTextBox::kLineBreak_Mode);
-    tbox.setBox(margin, margin,
-                w - margin, h - margin);
-    tbox.setSpacing(SkIntToScalar(3)/3, 0);
+        setupPagePaint(&paint, block.textSize);
 
+        // only the lines within the tile are drawn
+        block.layout->draw(canvas, margin, block.top, paint);
+        }
+    }
+
+void SkiWin::drawTitleTop(SkCanvas* canvas)
+    {
     SkPaint paint;
+    const char * title = mWindowTop->getTitle();
+
+    paint.setColor(SK_ColorWHITE);
+    paint.setDither(true);
     paint.setAntiAlias(true);
+    paint.setSubpixelText(true);
     paint.setLCDRenderText(true);
-    paint.setColor(fg);
-    tbox.setText(text, strlen(text), paint);
+    paint.setTextSize(15);
 
-    for (int i = 9; i < 24; i += 2)
+    canvas->drawColor(SK_ColorBLACK);
+
+    sp<SkiWinTextLayout> layout =
+        mTextLayoutCache.get(title, strlen(title), paint);
+
+    layout->draw(canvas, 15, 25 - layout->getBaseline(), paint);
+    }
+
+/**
+ * drawWindow - Draw a SampleWindow into the locked canvas of its view.
+ *
+ * In direct rendering mode the window draws straight into the surface
+ * buffer. Otherwise it brings its own bitmap up to date, which is then
+ * copied into the buffer, converted by writePixels() where it can.
+ *
+ * Windows draw alongside each other and the other views of the frame. A
+ * sample's drawing state lives in its own view, the animation clock is
+ * only read while a frame draws.
+ */
+
+void SkiWin::drawWindow(const sp<SkiWinView>& view, SkOSWindow* window,
+                        SkCanvas* canvas)
+    {
+    int dx, dy;
+
+    view->getContentOffset(&dx, &dy);
+
+    if (view->isDirectRendering())
+        {
+        SkAutoCanvasRestore acr(canvas, true);
+
+        canvas->translate(SkIntToScalar(dx), SkIntToScalar(dy));
+        canvas->clipRect(SkRect::MakeWH(window->width(), window->height()));
+
+        window->draw(canvas);
+        }
+    else
         {
-        paint.setTextSize(SkIntToScalar(i));
-        tbox.draw(canvas);
-        canvas->translate(0, tbox.getTextHeight() + paint.getFontSpacing());
+        window->update(NULL);
+
+        if (!view->writePixels(window->getBitmap(), dx, dy))
+            canvas->drawBitmap(window->getBitmap(), dx, dy);
         }
     }
 
-/* This routine returns the size of the file it is called with. */
-int getFileSize(FILE *input)
+void SkiWin::drawContentTop(SkCanvas* canvas)
     {
-    int fileSizeBytes;
-    fseek(input, 0, SEEK_END);
-    fileSizeBytes = ftell(input);
-    fseek(input, 0, SEEK_SET);
-    return fileSizeBytes;
+    drawWindow(mContentViewTop, mWindowTop, canvas);
     }
 
-/* This routine reads the entire file into memory. */
+/**
+ * drawContentMid - Draw the page at its scroll position from tiles.
+ *
+ * Only tiles that were never drawn, or were dropped since, are rendered,
+ * everything else is a blit. Below the end of a short page is white.
+ */
 
-char * readWholeFile (const char * file_name, size_t * size)
+void SkiWin::drawContentMid(SkCanvas* canvas)
     {
-    unsigned s;
-    char * contents;
-    FILE * f;
-    size_t bytes_read;
-    int status;
+    SkIRect bounds = mContentViewMid->getBounds();
+    SkIRect area;
+    SkRect clip;
+
+    if (!canvas->getClipBounds(&clip))
+        return;
+
+    clip.roundOut(&area);
+
+    if (!area.intersect(0, 0, bounds.width(), bounds.height()))
+        return;
+
+    int end = mPageHeight - mPageScroll;
+
+    if (end < area.fBottom)
+        {
+        SkAutoCanvasRestore acr(canvas, true);
+
+        canvas->clipRect(SkRect::MakeLTRB(0, SkIntToScalar(end),
+                                          SkIntToScalar(bounds.width()),
+                                          SkIntToScalar(bounds.height())));
+        canvas->drawColor(SK_ColorWHITE);
+        }
+
+    area.offset(0, mPageScroll);
 
-    f = fopen (file_name, "rb");
-    if (! f)
+    mPageTiles.draw(canvas, area, area.fLeft, area.fTop - mPageScroll);
+    }
+
+void SkiWin::drawTitleBot(SkCanvas* canvas)
+    {
+    if (mLogoBuf == NULL)
         {
-        fprintf (stderr, "Could not open '%s': %s.\n", file_name,
-                 strerror (errno));
-        return NULL;
+        SkPaint paint;
+        int remain;
+        int ystart = 25;
+        const char * title = mWindowBot->getTitle();
+
+        paint.setColor(SK_ColorWHITE);
+        paint.setDither(true);
+        paint.setAntiAlias(true);
+        paint.setSubpixelText(true);
+        paint.setLCDRenderText(true);
+        paint.setTextSize(10);
+
+        canvas->drawColor(SK_ColorBLACK);
+
+        remain = strlen(title);
+
+        while (remain > 0)
+            {
+            int len = remain > 10 ? 10 : remain;
+
+            sp<SkiWinTextLayout> layout =
+                mTextLayoutCache.get(title, len, paint);
+
+            layout->draw(canvas, 2, ystart - layout->getBaseline(), paint);
+
+            title += len;
+            ystart += 25;
+            remain -= len;
+            }
         }
-    s = getFileSize(f);
-    contents = (char *)malloc (s + 1);
-    if (! contents)
+    else if (!mVideoFrame.isNull())
         {
-        fprintf (stderr, "Not enough memory.\n");
-        return NULL;
+        drawImage(canvas, mVideoFrame);
         }
-    bytes_read = fread (contents, sizeof (unsigned char), s, f);
-    if (bytes_read != s)
+    }
+
+void SkiWin::drawContentBot(SkCanvas* canvas)
+    {
+    if (mLogoBuf == NULL)
         {
-        fprintf (stderr, "Short read of '%s': expected %d bytes "
-                 "but got %d: %s.\n", file_name, s, bytes_read,
-                 strerror (errno));
-        return NULL;
+        drawWindow(mContentViewBot, mWindowBot, canvas);
         }
-    status = fclose (f);
-    if (status != 0)
+    else
         {
-        fprintf (stderr, "Error closing '%s': %s.\n", file_name,
-                 strerror (errno));
-        return NULL;
+        SkBitmap bitmap;
+
+        // the logo never changes, only decode it the first time
+        if (mImageCache.decode(mLogoBuf, mLogoBufLen, &bitmap))
+            drawImage(canvas, bitmap);
         }
-    *size = bytes_read;
-    return contents;
     }
 
-bool SkiWin::android()
+void SkiWin::drawView(const sp<SkiWinView>& view, SkCanvas* canvas)
     {
-    SkCanvas* contentCanvasTop;
-    SkCanvas* contentCanvasMid;
-    SkCanvas* contentCanvasBot;
-    SkCanvas* titileCanvasTop;
-    SkCanvas* titileCanvasBot;
-    SkBitmap bitmap;
-    size_t  bufferLen;
-    char * buffer;
-    size_t  imgBufLen;
-    char * imgBuf;
-
-    int fileno = 0;
-    size_t  newScreenImgBufLen = 0;
-    size_t  screenImgBufLen = 0;
-    char * screenImgBuf = NULL;
-    char filename[50];
-    FILE *f;
-
-    Rect rect(mWidth, mHeight);
+    if (view == mTitleViewTop)
+        drawTitleTop(canvas);
+    else if (view == mContentViewTop)
+        drawContentTop(canvas);
+    else if (view == mContentViewMid)
+        drawContentMid(canvas);
+    else if (view == mTitleViewBot)
+        drawTitleBot(canvas);
+    else if (view == mContentViewBot)
+        drawContentBot(canvas);
+    else if (view->getContext() != NULL)
+        drawWindow(view, reinterpret_cast<SkOSWindow*>(view->getContext()),
+                   canvas);
+    }
 
-    mWindowTop->resize(320, 150);
-    mWindowMid->resize(320, 150);
-    mWindowBot->resize(320, 150);
-    mWindowMid->update(NULL);
+/**
+ * drawViewTask - Lock and draw one of the views damaged in this frame.
+ *
+ * Runs on any thread of the frame executor, views share no drawing state.
+ * Flattened views all draw into the one buffer, each into its own visible
+ * part of it, which no other view touches.
+ */
+
+void SkiWin::drawViewTask(void* context, size_t index)
+    {
+    SkiWin* skiwin = reinterpret_cast<SkiWin*>(context);
+    const sp<SkiWinView>& view = skiwin->mFrameViews[index];
+    SkRegion& damage = skiwin->mFrameDamage.editItemAt(index);
+    SkCanvas* canvas;
 
-    buffer = SkiWinURLResourceGet("www.baidu.com", &bufferLen);
+    if (skiwin->mFlattened)
+        {
+        SkIRect flat = skiwin->mFlatView->getBounds();
+        SkIRect bounds = view->getBounds();
 
-    if (buffer == NULL) buffer = (char *)gText;
+        canvas = view->lockFlattenedCanvas(skiwin->mFlatBuffer,
+                                           bounds.fLeft - flat.fLeft,
+                                           bounds.fTop - flat.fTop,
+                                           damage);
+        }
+    else
+        {
+        // only the damaged part of the buffer is redrawn, the rest is
+        // carried over from the previous buffer
+        canvas = view->lockCanvas(&damage);
 
-    imgBuf = SkiWinURLResourceGet("www.baidu.com/img/bdlogo.gif", &imgBufLen);
+        // nothing to post, the damage went back to the view
+        skiwin->mFrameLocked.editItemAt(index) = canvas != NULL;
+        }
 
-    do
+    if (canvas)
         {
-        mWindowTop->update(NULL);
-        mWindowBot->update(NULL);
+        nsecs_t start = systemTime();
 
-        titileCanvasTop = mTitleViewTop->lockCanvas(rect);
-        if (titileCanvasTop)
-            {
-            SkPaint paint;
-            const char * title = mWindowTop->getTitle();
+        skiwin->drawView(view, canvas);
+
+        SkiWinFrameStats::get()->recordTime(view->getStatsRow(),
+                                            STATS_DRAW, start);
+        }
 
-            paint.setColor(SK_ColorWHITE);
-            paint.setDither(true);
-            paint.setAntiAlias(true);
-            paint.setSubpixelText(true);
-            paint.setLCDRenderText(true);
-            paint.setTextSize(15);
+    if (skiwin->mFlattened)
+        view->unlockFlattenedCanvas();
+    }
 
-            titileCanvasTop->clear(SK_ColorBLACK);
+/**
+ * computeVisibleRegions - The part of every view not hidden by views above.
+ *
+ * Walks the views from the top down, collecting the screen area of the
+ * ones nothing shows through. The regions are in view space. A view
+ * waiting for its first frame is drawn to be shown, but covers nothing
+ * yet, hidden views have nothing visible.
+ */
 
-            titileCanvasTop->drawText(title, strlen(title), 15, 25, paint);
-            }
-        mTitleViewTop->unlockCanvasAndPost();
+static void computeVisibleRegions(const Vector< sp<SkiWinView> >& views,
+                                  Vector<SkRegion>* visible)
+    {
+    SkRegion covered;
 
-        contentCanvasTop = mContentViewTop->lockCanvas(rect);
-        if (contentCanvasTop)
-            {
-            contentCanvasTop->drawBitmap(mWindowTop->getBitmap(), 0, 30);
-            }
-        mContentViewTop->unlockCanvasAndPost();
+    visible->clear();
+    visible->insertAt(SkRegion(), 0, views.size());
 
-        contentCanvasMid = mContentViewMid->lockCanvas(rect);
-        if (contentCanvasMid)
-            {
-            SkPaint paint;
-            int color = 0xff00ff77;
-            paint.setARGB(color>>24 & 0xff,
-                          color>>16 & 0xff,
-                          color>>8 & 0xff,
-                          color & 0xff);
-
-            SkRect rect1;
-            rect1.fLeft = 100;
-            rect1.fTop = 0;
-            rect1.fRight = 300;
-            rect1.fBottom = 120;
-
-            //contentCanvasMid->drawRect(rect1, paint);
-            //contentCanvasMid->drawBitmap(mWindowMid->getBitmap(), 0, 0);
-            //contentCanvasMid->drawLine(100, 0, 100, 480, paint);
-            drawText(contentCanvasMid, 320, 150, SK_ColorBLACK, SK_ColorWHITE, buffer);
-            }
-        mContentViewMid->unlockCanvasAndPost();
+    for (size_t i = views.size(); i > 0; i--)
+        {
+        const sp<SkiWinView>& view = views[i - 1];
+        SkIRect bounds = view->getBounds();
 
-        titileCanvasBot = mTitleViewBot->lockCanvas(rect);
-        if (titileCanvasBot)
-            {
-            if (imgBuf == NULL)
-                {
-                SkPaint paint;
-                int remain;
-                int ystart = 25;
-                const char * title = mWindowBot->getTitle();
+        if (!view->isVisible() && !view->isShowPending())
+            continue;
 
-                paint.setColor(SK_ColorWHITE);
-                paint.setDither(true);
-                paint.setAntiAlias(true);
-                paint.setSubpixelText(true);
-                paint.setLCDRenderText(true);
-                paint.setTextSize(10);
+        SkRegion& region = visible->editItemAt(i - 1);
 
-                titileCanvasBot->clear(SK_ColorBLACK);
+        region.setRect(bounds);
+        region.op(covered, SkRegion::kDifference_Op);
+        region.translate(-bounds.fLeft, -bounds.fTop);
 
-                remain = strlen(title);
+        if (view->isOccluding())
+            covered.op(bounds, SkRegion::kUnion_Op);
+        }
+    }
 
-                while (remain > 10)
-                    {
-                    titileCanvasBot->drawText(title, 10, 2, ystart, paint);
+/**
+ * shouldFlatten - Whether this frame is better composed by SkiWin itself.
+ *
+ * SurfaceFlinger composes every layer in full, overlapping or not, and
+ * each layer has its own buffer queue. Once there are enough views, or
+ * they overlap enough, drawing them into one surface is cheaper. Views
+ * blended with what is below them can only be composed by SurfaceFlinger.
+ */
 
-                    title += 10;
-                    ystart += 25;
-                    remain -= 10;
-                    }
+bool SkiWin::shouldFlatten(const Vector< sp<SkiWinView> >& views)
+    {
+    SkRegion area;
+    uint64_t total = 0;
+    int count = 0;
 
-                if (remain > 0)
-                    titileCanvasBot->drawText(title, 10, 2, ystart, paint);
-                }
-            else
-                {
-                sprintf(filename, "/data/screenvideo/screen-%d.png", fileno++);
-                screenImgBuf = readWholeFile(filename, &screenImgBufLen);
-                if (screenImgBuf != NULL)
-                    {
+    if (mFlattenMode == FLATTEN_NEVER)
+        return false;
 
-                    printf("Opened file %s with len %d buf %p\n", filename, screenImgBufLen, screenImgBuf);
+    // animations only move surfaces, a flattened view would be redrawn
+    if (mAnimator->isAnimating())
+        return false;
 
-                    drawImage(titileCanvasBot, screenImgBuf, screenImgBufLen);
-                    
-                    free(screenImgBuf);
-                    }
-                else
-                    fileno = 0;
-                }
-            }
-        mTitleViewBot->unlockCanvasAndPost();
+    for (size_t i = 0; i < views.size(); i++)
+        {
+        const sp<SkiWinView>& view = views[i];
+        SkIRect bounds = view->getBounds();
 
-        contentCanvasBot = mContentViewBot->lockCanvas(rect);
-        if (contentCanvasBot)
-            {
-            if (imgBuf == NULL)
-                contentCanvasBot->drawBitmap(mWindowBot->getBitmap(), 0, 0);
-            else
-                drawImage(contentCanvasBot, imgBuf, imgBufLen);
-            }
-        mContentViewBot->unlockCanvasAndPost();
+        if (!view->isVisible() && !view->isShowPending())
+            continue;
 
-        usleep(100000);
+        if (view->isTranslucent() || view->hasTransform())
+            return false;
 
-        checkExit();
+        if (!bounds.intersect(0, 0, mWidth, mHeight))
+            continue;
+
+        area.op(bounds, SkRegion::kUnion_Op);
+        total += uint64_t(bounds.width()) * bounds.height();
+        count++;
         }
-    while (!exitPending());
 
-    return false;
-    }
+    if (count == 0)
+        return false;
 
-sp<SkiWinView> SkiWin::updateFocusView(int x, int y)
-    {
-    if (mContentViewTop->isFocus(x, y) == true)
-        mFocusView = mContentViewTop;
-    else if (mContentViewBot->isFocus(x, y) == true)
-        mFocusView = mContentViewBot;
-    else
-        mFocusView = NULL;
+    if (mFlattenMode == FLATTEN_ALWAYS || count >= FLATTEN_MIN_VIEWS)
+        return true;
 
-    return mFocusView;
+    uint64_t covered = 0;
+
+    for (SkRegion::Iterator it(area); !it.done(); it.next())
+        covered += uint64_t(it.rect().width()) * it.rect().height();
+
+    // pixels SurfaceFlinger would compose more than once
+    return (total - covered) * 100 >= covered * FLATTEN_MIN_OVERDRAW;
     }
 
-sp<SkiWinView> SkiWin::getFocusView()
+/**
+ * updateFlatView - Get the flattened surface to cover bounds.
+ *
+ * Returns false if there is no surface. Whenever it is new or moves, what
+ * was drawn into it is forgotten so the next frame fills it in full.
+ */
+
+bool SkiWin::updateFlatView(const SkIRect& bounds, PixelFormat format)
     {
-    return mFocusView;
+    if (mFlatView != NULL && mFlatView->getPixelFormat() != format)
+        {
+        mWindowManager->destroyCompositorWindow(mFlatView);
+        mFlatView = NULL;
+        }
+
+    if (mFlatView == NULL)
+        {
+        mFlatView = mWindowManager->createCompositorWindow(
+            String8("FlatView"), bounds.fLeft, bounds.fTop,
+            bounds.width(), bounds.height(), FLAT_VIEW_LAYER, format);
+
+        if (mFlatView == NULL)
+            return false;
+
+        // SkiWin fills in what no view covers itself
+        mFlatView->setOpaque(true);
+
+        mFlatWindows.clear();
+        mFlatBackground.setEmpty();
+        }
+    else if (mFlatView->getBounds() != bounds)
+        {
+        SkiWinTransaction t(mBackend);
+
+        t.setPosition(mFlatView, bounds.fLeft, bounds.fTop);
+        t.setSize(mFlatView, bounds.width(), bounds.height());
+        t.apply();
+
+        mFlatWindows.clear();
+        mFlatBackground.setEmpty();
+        }
+
+    return true;
     }
 
-void SkiWin::hide(void)
+/**
+ * setFlattened - Switch between a surface per view and one for them all.
+ *
+ * Either way the new surfaces are shown with their first frame, on top of
+ * the old ones which are only hidden after that, so the switch is not
+ * seen.
+ */
+
+void SkiWin::setFlattened(const Vector< sp<SkiWinView> >& views,
+                          bool flattened)
     {
-    mTitleViewTop->hide();
-    mTitleViewBot->hide();
-    mContentViewTop->hide();
-    mContentViewMid->hide();
-    mContentViewBot->hide();
-    }
+    ALOGD("%s views", flattened ? "flattening" : "unflattening");
+
+    mFlattened = flattened;
+
+    mFlatWindows.clear();
+    mFlatBackground.setEmpty();
+
+    if (!flattened)
+        {
+        for (size_t i = 0; i < views.size(); i++)
+            views[i]->setFlattened(false);
+        }
+    }
+
+/**
+ * drawLayeredFrame - Produce a new buffer for every view that has damage.
+ *
+ * Views without damage keep showing their last posted buffer, so an idle
+ * screen does not lock, clear or post anything. Damaged views only redraw
+ * the damaged area.
+ *
+ * The surfaces are independent, so the damaged views are drawn
+ * concurrently by the frame executor. Nothing is posted before all of
+ * them are done, so the views of a frame still reach the screen together.
+ *
+ * Only damage in the visible part of a view is drawn, a view covered by
+ * opaque views above, or hidden, is not even locked. What it could not
+ * draw is kept until it comes into view.
+ */
+
+void SkiWin::drawLayeredFrame(const Vector< sp<SkiWinView> >& views)
+    {
+    mFrameViews.clear();
+    mFrameDamage.clear();
+
+    for (size_t i = 0; i < views.size(); i++)
+        {
+        const sp<SkiWinView>& view = views[i];
+        SkRegion damage;
+
+        if (!view->getDamage(&damage, mFrameVisible[i]))
+            continue;
+
+        mFrameViews.add(view);
+        mFrameDamage.add(damage);
+        }
+
+    if (mFrameViews.isEmpty())
+        return;
+
+    // drawViewTask() clears the views it cannot lock
+    mFrameLocked.clear();
+    mFrameLocked.insertAt(true, 0, mFrameViews.size());
+
+    nsecs_t start = systemTime();
+
+    mFrameExecutor.execute(drawViewTask, this, mFrameViews.size());
+
+    for (size_t i = 0; i < mFrameViews.size(); i++)
+        {
+        if (!mFrameLocked[i])
+            continue;
+
+        mFrameViews[i]->unlockCanvasAndPost();
+        recordInputShown(mFrameViews[i]);
+        }
+
+    SkiWinFrameStats::get()->recordTime(STATS_ROW_FRAME, STATS_FRAME, start);
+
+    mFrameViews.clear();
+    }
+
+/**
+ * drawFlattenedFrame - Compose the damaged parts of all views into one
+ * surface.
+ *
+ * The flattened surface covers the bounds of the shown views. Besides the
+ * damage the views report, everything that came into view since the last
+ * frame is redrawn, parts of views uncovered or moved and background left
+ * behind, so the surface matches what SurfaceFlinger would have composed.
+ * Background is black.
+ */
+
+void SkiWin::drawFlattenedFrame(const Vector< sp<SkiWinView> >& views)
+    {
+    SkIRect bounds = SkIRect::MakeEmpty();
+    bool trueColor = false;
+
+    for (size_t i = 0; i < views.size(); i++)
+        {
+        if (!views[i]->isVisible())
+            continue;
+
+        bounds.join(views[i]->getBounds());
+
+        if (views[i]->getPixelFormat() == PIXEL_FORMAT_RGBX_8888)
+            trueColor = true;
+        }
+
+    if (!bounds.intersect(0, 0, mWidth, mHeight))
+        {
+        // nothing to show, the views keep their damage for later
+        if (mFlatView != NULL)
+            {
+            mWindowManager->destroyCompositorWindow(mFlatView);
+            mFlatView = NULL;
+            }
+
+        mFlatWindows.clear();
+        mFlatBackground.setEmpty();
+        return;
+        }
+
+    if (!updateFlatView(bounds, trueColor ? PIXEL_FORMAT_RGBX_8888 :
+                                            PIXEL_FORMAT_RGB_565))
+        return;
+
+    Vector<FlatWindow> windows;
+    SkRegion background(bounds);
+    SkRegion dirty;
+
+    for (size_t i = 0; i < views.size(); i++)
+        {
+        const sp<SkiWinView>& view = views[i];
+        FlatWindow window;
+        SkRegion damage;
+
+        window.view = view;
+        window.bounds = view->getBounds();
+        window.visible = mFrameVisible[i];
+        window.visible.translate(window.bounds.fLeft, window.bounds.fTop);
+        window.visible.op(bounds, SkRegion::kIntersect_Op);
+
+        if (view->getDamage(&damage, mFrameVisible[i]))
+            {
+            damage.translate(window.bounds.fLeft, window.bounds.fTop);
+            dirty.op(damage, SkRegion::kUnion_Op);
+            }
+
+        SkRegion exposed(window.visible);
+
+        for (size_t j = 0; j < mFlatWindows.size(); j++)
+            {
+            // a view that moved has none of its pixels where they were
+            if (mFlatWindows[j].view == view &&
+                mFlatWindows[j].bounds == window.bounds)
+                exposed.op(mFlatWindows[j].visible, SkRegion::kDifference_Op);
+            }
+
+        dirty.op(exposed, SkRegion::kUnion_Op);
+        background.op(window.visible, SkRegion::kDifference_Op);
+
+        windows.add(window);
+        }
+
+    SkRegion exposed(background);
+
+    exposed.op(mFlatBackground, SkRegion::kDifference_Op);
+    dirty.op(exposed, SkRegion::kUnion_Op);
+
+    mFlatWindows = windows;
+    mFlatBackground = background;
+
+    if (!dirty.op(bounds, SkRegion::kIntersect_Op))
+        return;
+
+    nsecs_t start = systemTime();
+
+    SkRegion locked(dirty);
+
+    locked.translate(-bounds.fLeft, -bounds.fTop);
+
+    SkCanvas* canvas = mFlatView->lockCanvas(&locked);
+    if (canvas == NULL)
+        return;
+
+    mFlatBuffer = mFlatView->getBuffer();
+
+    SkRegion clear(locked);
+
+    // the buffer queue may have widened it, all of that is redrawn
+    locked.translate(bounds.fLeft, bounds.fTop);
+
+    background.translate(-bounds.fLeft, -bounds.fTop);
+
+    if (clear.op(background, SkRegion::kIntersect_Op))
+        {
+        canvas->save();
+        canvas->clipRegion(clear);
+        canvas->drawColor(SK_ColorBLACK);
+        canvas->restore();
+        }
+
+    mFrameViews.clear();
+    mFrameDamage.clear();
+
+    for (size_t i = 0; i < windows.size(); i++)
+        {
+        SkRegion area(locked);
+
+        if (!area.op(windows[i].visible, SkRegion::kIntersect_Op))
+            continue;
+
+        area.translate(-windows[i].bounds.fLeft, -windows[i].bounds.fTop);
+
+        mFrameViews.add(windows[i].view);
+        mFrameDamage.add(area);
+        }
+
+    mFrameExecutor.execute(drawViewTask, this, mFrameViews.size());
+
+    mFlatBuffer.reset();
+    mFlatView->unlockCanvasAndPost();
+
+    // the views drawn into it are on the screen with it
+    for (size_t i = 0; i < mFrameViews.size(); i++)
+        recordInputShown(mFrameViews[i]);
+
+    // the views are on the screen through the flattened surface now
+    if (mFlatReleasePending)
+        {
+        mBackend->openTransaction();
+
+        for (size_t i = 0; i < views.size(); i++)
+            views[i]->releaseFlattenedSurface();
+
+        mBackend->closeTransaction();
+
+        mFlatReleasePending = false;
+        }
+
+    SkiWinFrameStats::get()->recordTime(STATS_ROW_FRAME, STATS_FRAME, start);
+
+    mFrameViews.clear();
+    }
+
+/**
+ * drawFrame - Bring the screen up to date with the damage of all views.
+ *
+ * Windows opened since the last frame are picked up, they are damaged all
+ * over until drawn. The views are composed by SurfaceFlinger from a
+ * surface each, or flattened into one surface by SkiWin, whichever
+ * shouldFlatten() finds cheaper for the current layout.
+ */
+
+void SkiWin::drawFrame()
+    {
+    Vector< sp<SkiWinView> > views;
+
+    // windows are not closed under a frame in progress
+    Mutex::Autolock _l(mWindowManager->getFrameLock());
+
+    mWindowManager->getWindows(&views);
+
+    // every window of the frame animates to the same time
+    SampleWindow::AdvanceAnimTime();
+
+    bool flatten = shouldFlatten(views);
+
+    if (flatten != mFlattened)
+        setFlattened(views, flatten);
+
+    if (mFlattened)
+        {
+        // windows opened since the last frame join in as well
+        for (size_t i = 0; i < views.size(); i++)
+            {
+            if (views[i]->isFlattened())
+                continue;
+
+            views[i]->setFlattened(true);
+            mFlatReleasePending = true;
+            }
+        }
+
+    computeVisibleRegions(views, &mFrameVisible);
+
+    if (mFlattened)
+        {
+        drawFlattenedFrame(views);
+        }
+    else
+        {
+        drawLayeredFrame(views);
+
+        // the views have their own surfaces back and drawn by now
+        if (mFlatView != NULL)
+            {
+            mWindowManager->destroyCompositorWindow(mFlatView);
+            mFlatView = NULL;
+            }
+        }
+
+    // input that changed nothing on the screen is not shown by any frame
+    mInputShown.clear();
+    }
+
+/**
+ * nextTimeout - Shorten timeout to run out at when, if that is sooner.
+ *
+ * when is LLONG_MAX if nothing is due.
+ */
+
+static nsecs_t nextTimeout(nsecs_t timeout, nsecs_t when)
+    {
+    if (when == LLONG_MAX)
+        return timeout;
+
+    nsecs_t now = systemTime();
+
+    if (when <= now)
+        return 0;
+
+    return when - now < timeout ? when - now : timeout;
+    }
+
+/**
+ * waitForFrame - Sleep until some view is damaged or the timeout expires.
+ *
+ * SkEvents (delayed invals, animation ticks) are dispatched while waiting,
+ * so a SampleWindow that invalidates itself from an event gets its frame
+ * in the same iteration.
+ */
+
+void SkiWin::waitForFrame(nsecs_t timeout)
+    {
+    SkiWinEventPump* pump = SkiWinEventPump::get();
+
+    if (android_atomic_acquire_load(&mFramePending))
+        timeout = 0;
+
+    pump->waitAndDispatch(timeout);
+
+    android_atomic_release_store(0, &mFramePending);
+    }
+
+void SkiWin::scheduleFrame(void)
+    {
+    android_atomic_release_store(1, &mFramePending);
+
+    SkiWinEventPump::get()->wake();
+    }
+
+/**
+ * isInputQueueFull - Whether queueInput() would drop an event now.
+ *
+ * Same thread as queueInput() only.
+ */
+
+bool SkiWin::isInputQueueFull()
+    {
+    return mInputQueue.isFull();
+    }
+
+/**
+ * queueInput - Hand an input event over to the SkiWin thread.
+ *
+ * Only called from the input reader thread, the one producer of the
+ * input queue.
+ */
+
+void SkiWin::queueInput(const SkiWinInputEvent& event)
+    {
+    if (!mInputQueue.push(event))
+        {
+        ALOGW("input queue full, event dropped");
+
+        // a later move makes up for a lost one, nothing does for a down
+        // or an up
+        if (event.type != SkiWinInputEvent::TYPE_MOTION ||
+            event.action != AMOTION_EVENT_ACTION_MOVE)
+            android_atomic_release_store(1, &mInputLost);
+        }
+
+    SkiWinEventPump::get()->wake();
+    }
+
+/**
+ * findPointer - The index of pointer id in a touch event, -1 if it is not
+ * one of its pointers.
+ */
+
+static int32_t findPointer(const SkiWinInputEvent& event, int32_t id)
+    {
+    for (int32_t i = 0; i < event.pointerCount; i++)
+        {
+        if (event.pointerIds[i] == id)
+            return i;
+        }
+
+    return -1;
+    }
+
+/**
+ * dispatchInput - Deliver the queued input events, oldest first.
+ *
+ * Runs on the SkiWin thread before a frame is drawn, so windows only ever
+ * handle input between frames, and the frame shows all input queued
+ * before it.
+ *
+ * A run of moves is delivered as one, the latest position, the earlier
+ * ones kept in the motion history, so a touch panel reporting faster than
+ * the frame rate does not cost a dispatch per report. Any other event
+ * delivers the moves before it first.
+ */
+
+void SkiWin::dispatchInput()
+    {
+    SkiWinInputEvent event;
+    SkiWinInputEvent move;
+    bool moving = false;
+    size_t handled = 0;
+
+    mMotionHistory.clear();
+    mInputTimes.clear();
+
+    while (mInputQueue.pop(&event))
+        {
+        mInputTimes.add(event.eventTime);
+        recordInput(STATS_INPUT_QUEUED, mInputTimes.size() - 1,
+                    mInputTimes.size());
+
+        if (event.type == SkiWinInputEvent::TYPE_MOTION &&
+            event.action == AMOTION_EVENT_ACTION_MOVE)
+            {
+            if (moving)
+                {
+                // the samples follow the finger scrolling the page, if any
+                int32_t index = mPageDragging ?
+                                findPointer(move, mPageDragPointer) : 0;
+
+                if (index >= 0)
+                    {
+                    SkiWinMotionSample sample;
+
+                    sample.x = move.pointerX[index];
+                    sample.y = move.pointerY[index];
+                    sample.eventTime = move.eventTime;
+
+                    mMotionHistory.add(sample);
+                    }
+                }
+
+            move = event;
+            moving = true;
+            mInputMoves++;
+            continue;
+            }
+
+        if (moving)
+            {
+            dispatchMotion(move);
+            mMotionHistory.clear();
+            moving = false;
+
+            // the moves are done, not the event just taken
+            handled = inputDispatched(handled, mInputTimes.size() - 1);
+            }
+
+        if (event.type == SkiWinInputEvent::TYPE_KEY)
+            dispatchKey(event);
+        else
+            dispatchMotion(event);
+
+        handled = inputDispatched(handled, mInputTimes.size());
+        }
+
+    if (moving)
+        {
+        dispatchMotion(move);
+        mMotionHistory.clear();
+
+        inputDispatched(handled, mInputTimes.size());
+        }
+
+    if (android_atomic_cmpxchg(1, 0, &mInputLost) == 0)
+        cancelInput();
+    }
+
+/**
+ * cancelInput - End the touch that events lost to a full input queue left
+ * open.
+ *
+ * Every pointer still down in the focused window lifts where it was last
+ * seen, and a drag of the page stops without flinging. Whatever follows
+ * starts afresh with its next down.
+ */
+
+void SkiWin::cancelInput()
+    {
+    KeyedVector<int32_t, SkIPoint> down(mTouchDown);
+
+    ALOGW("input lost, touch cancelled");
+
+    for (size_t i = 0; i < down.size(); i++)
+        dispatchTouch(down.keyAt(i), down.valueAt(i).fX, down.valueAt(i).fY,
+                      SkView::Click::kUp_State);
+
+    mTouchDown.clear();
+
+    if (mPageDragging)
+        {
+        if (mPageDragPointer >= 0)
+            mPageScroller.touchCancel();
+
+        mPageDragging = false;
+        mPageDragPointer = -1;
+        }
+    }
+
+/**
+ * inputDispatched - Count the events of mInputTimes from first up to last
+ * as handled, and have them wait for a post of the view they went to.
+ *
+ * Returns last, where the next lot starts.
+ */
+
+size_t SkiWin::inputDispatched(size_t first, size_t last)
+    {
+    recordInput(STATS_INPUT_HANDLED, first, last);
+
+    if (mInputTarget != NULL)
+        {
+        for (size_t i = first; i < last; i++)
+            {
+            PendingInput pending;
+
+            pending.view = mInputTarget;
+            pending.eventTime = mInputTimes[i];
+
+            mInputShown.add(pending);
+            }
+
+        mInputTarget = NULL;
+        }
+
+    return last;
+    }
+
+/**
+ * recordInputShown - Count the input that went to view as shown, it has
+ * just posted the first buffer drawn after it.
+ */
+
+void SkiWin::recordInputShown(const sp<SkiWinView>& view)
+    {
+    nsecs_t now = systemTime();
+
+    for (size_t i = mInputShown.size(); i-- > 0; )
+        {
+        const PendingInput& pending = mInputShown[i];
+
+        if (pending.view != view)
+            continue;
+
+        // a clock stepping back would make it negative
+        if (pending.eventTime <= now)
+            SkiWinFrameStats::get()->record(STATS_ROW_INPUT, STATS_INPUT_SHOWN,
+                                            ns2us(now - pending.eventTime));
+
+        mInputShown.removeAt(i);
+        }
+    }
+
+/**
+ * recordInput - Count how long ago the input events of mInputTimes from
+ * first up to last happened, as metric of the input stats row.
+ *
+ * Returns last, where the next lot starts.
+ */
+
+size_t SkiWin::recordInput(int metric, size_t first, size_t last)
+    {
+    nsecs_t now = systemTime();
+
+    for (size_t i = first; i < last; i++)
+        {
+        // a clock stepping back would make it negative
+        if (mInputTimes[i] <= now)
+            SkiWinFrameStats::get()->record(STATS_ROW_INPUT, metric,
+                                            ns2us(now - mInputTimes[i]));
+        }
+
+    return last;
+    }
+
+/**
+ * getMotionHistory - The positions a move being dispatched went through
+ * since the previous one, oldest first, without the latest.
+ *
+ * Only valid while a move is dispatched, for whatever needs every sample,
+ * like velocity tracking or drawing strokes.
+ */
+
+const Vector<SkiWinMotionSample>& SkiWin::getMotionHistory()
+    {
+    return mMotionHistory;
+    }
+
+/*
+ * The character a key types without modifiers, 0 for keys that type none.
+ * There is no key character map to go through, the digits, letters and
+ * space are all the samples take.
+ */
+
+static SkUnichar AndroidKeycodeToChar(int32_t keyCode)
+    {
+    if (keyCode >= AKEYCODE_0 && keyCode <= AKEYCODE_9)
+        return '0' + (keyCode - AKEYCODE_0);
+
+    if (keyCode >= AKEYCODE_A && keyCode <= AKEYCODE_Z)
+        return 'a' + (keyCode - AKEYCODE_A);
+
+    if (keyCode == AKEYCODE_SPACE)
+        return ' ';
+
+    return 0;
+    }
+
+void SkiWin::dispatchKey(const SkiWinInputEvent& event)
+    {
+    SkOSWindow* focusWindow = NULL;
+
+    ALOGV("key action %d %d", event.action,
+          AndroidKeycodeToSkKey(event.keyCode));
+
+    if (AKEYCODE_HOME == event.keyCode)
+        {
+        ALOGD("============@@@@@@@@@@@@@@@@@@@AKEYCODE_HOME pressed, hiding!\n");
+        hide();
+        }
+    else if (AKEYCODE_BACK == event.keyCode)
+        {
+        ALOGD("============@@@@@@@@@@@@@@@@@@@AKEYCODE_BACK pressed, exiting!\n");
+        exit(0);
+        }
+
+    if (mFocusView != NULL)
+        {
+        focusWindow = reinterpret_cast<SkOSWindow*>(mFocusView->getContext());
+
+        if (focusWindow != NULL)
+            {
+            if (event.action == AKEY_EVENT_ACTION_DOWN)
+                {
+                SkUnichar uni = AndroidKeycodeToChar(event.keyCode);
+
+                // the number keys scroll SampleWindows in place
+                if (!focusWindow->handleKey(AndroidKeycodeToSkKey(event.keyCode)) &&
+                    uni != 0)
+                    focusWindow->handleChar(uni);
+                }
+            else if (event.action == AKEY_EVENT_ACTION_UP)
+                {
+                focusWindow->handleKeyUp(AndroidKeycodeToSkKey(event.keyCode));
+                }
+
+            mInputTarget = mFocusView;
+            }
+        }
+    }
+
+/**
+ * dispatchMotion - Deliver a touch to the window it went down on, every
+ * pointer of it.
+ *
+ * The fingers after the first only reach the windows, the page scrolls
+ * with the first one and ignores the others.
+ */
+
+void SkiWin::dispatchMotion(const SkiWinInputEvent& event)
+    {
+    SkView::Click::State state;
+    int32_t index;
+
+    index = (event.action & AMOTION_EVENT_ACTION_POINTER_INDEX_MASK) >>
+            AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT;
+
+    switch (event.action & AMOTION_EVENT_ACTION_MASK)
+        {
+        case AMOTION_EVENT_ACTION_DOWN:       // MotionEvent.ACTION_DOWN
+            state = SkView::Click::kDown_State;
+            break;
+        case AMOTION_EVENT_ACTION_UP:       // MotionEvent.ACTION_UP
+        case AMOTION_EVENT_ACTION_CANCEL:  // MotionEvent.ACTION_CANCEL
+            state = SkView::Click::kUp_State;
+            break;
+        case AMOTION_EVENT_ACTION_POINTER_DOWN:
+        case AMOTION_EVENT_ACTION_POINTER_UP:
+            state = (event.action & AMOTION_EVENT_ACTION_MASK) ==
+                    AMOTION_EVENT_ACTION_POINTER_DOWN ?
+                    SkView::Click::kDown_State : SkView::Click::kUp_State;
+
+            if (!mPageDragging)
+                {
+                dispatchTouch(event.pointerIds[index], event.pointerX[index],
+                              event.pointerY[index], state);
+                return;
+                }
+
+            // the scroll ends when its finger lifts, the rest of the touch
+            // goes nowhere
+            if (state == SkView::Click::kUp_State &&
+                event.pointerIds[index] == mPageDragPointer)
+                {
+                mPageScroller.touchUp(event.pointerY[index], event.eventTime);
+                mPageDragPointer = -1;
+                }
+
+            mInputTarget = mContentViewMid;
+            return;
+        default:                            // MotionEvent.ACTION_MOVE
+            state = SkView::Click::kMoved_State;
+            break;
+        }
+
+    // drags that start on the page scroll it, no window sees them
+    if (scrollPage(event, state))
+        {
+        mInputTarget = mContentViewMid;
+        return;
+        }
+
+    if (state == SkView::Click::kMoved_State)
+        mInputMoveDispatches++;
+
+    // the window a touch went down on gets the rest of it
+    if (state == SkView::Click::kDown_State)
+        updateFocusView(event.x, event.y);
+
+    for (int32_t i = 0; i < event.pointerCount; i++)
+        dispatchTouch(event.pointerIds[i], event.pointerX[i],
+                      event.pointerY[i], state);
+    }
+
+/**
+ * dispatchTouch - Hand one pointer of a touch to the focused window.
+ */
+
+void SkiWin::dispatchTouch(int32_t id, int32_t x, int32_t y,
+                           SkView::Click::State state)
+    {
+    SampleWindow* focusWindow;
+    int32_t x0, y0;
+
+    if (mFocusView == NULL || mFocusView->getContext() == NULL)
+        return;
+
+    focusWindow = static_cast<SampleWindow*>(
+        reinterpret_cast<SkOSWindow*>(mFocusView->getContext()));
+
+    mFocusView->screenToViewSpace(x, y, &x0, &y0);
+
+    focusWindow->handleTouch(id, float(x0), float(y0), state);
+
+    if (state == SkView::Click::kUp_State)
+        mTouchDown.removeItem(id);
+    else
+        mTouchDown.replaceValueFor(id, SkIPoint::Make(x, y));
+
+    mInputTarget = mFocusView;
+    }
+
+/**
+ * scrollPage - Scroll the page with a touch that went down on its view.
+ *
+ * The page follows the pointer the touch went down with, looked up by its
+ * id in every event as the other fingers come and go. Returns false for
+ * touches that are not scrolling the page, they go to the windows.
+ */
+
+bool SkiWin::scrollPage(const SkiWinInputEvent& event,
+                        SkView::Click::State state)
+    {
+    if (state == SkView::Click::kDown_State)
+        {
+        mPageDragging = mWindowManager->findWindowAt(event.x, event.y) ==
+                        mContentViewMid;
+
+        if (mPageDragging)
+            {
+            mPageDragPointer = event.pointerIds[0];
+            mPageScroller.touchDown(event.y, event.eventTime);
+            }
+
+        return mPageDragging;
+        }
+
+    if (!mPageDragging)
+        return false;
+
+    int32_t index = findPointer(event, mPageDragPointer);
+
+    if (state == SkView::Click::kMoved_State)
+        {
+        if (index < 0)
+            return true;
+
+        // every sample counts for the fling velocity
+        for (size_t i = 0; i < mMotionHistory.size(); i++)
+            mPageScroller.touchMove(mMotionHistory[i].y,
+                                    mMotionHistory[i].eventTime);
+
+        mPageScroller.touchMove(event.pointerY[index], event.eventTime);
+        }
+    else
+        {
+        if (mPageDragPointer >= 0)
+            mPageScroller.touchUp(index >= 0 ? event.pointerY[index] : event.y,
+                                  event.eventTime);
+
+        mPageDragging = false;
+        mPageDragPointer = -1;
+        }
+
+    return true;
+    }
+
+static void SkiWinVideoFrameReady(void* context)
+    {
+    SkiWin* skiwin = reinterpret_cast<SkiWin*>(context);
+
+    skiwin->scheduleFrame();
+    }
+
+/**
+ * invalidateWindow - Route an SkOSWindow invalidation to the view showing it.
+ *
+ * The rectangle is in window space, it is moved by the content offset of
+ * the view before being accumulated as damage.
+ */
+
+void SkiWin::invalidateWindow(SkOSWindow* window, const SkIRect& rect)
+    {
+    sp<SkiWinView> view;
+
+    if (window == mWindowTop)
+        view = mContentViewTop;
+    else if (window == mWindowBot && mLogoBuf == NULL)
+        view = mContentViewBot;
+
+    if (view == NULL)
+        return;
+
+    int dx, dy;
+    SkIRect r(rect);
+
+    view->getContentOffset(&dx, &dy);
+    r.offset(dx, dy);
+
+    view->invalidate(r);
+
+    scheduleFrame();
+    }
+
+/**
+ * scrollWindow - Move the pixels of a SkOSWindow within rect by dx, dy.
+ *
+ * rect is in window space. The view showing the window moves what is in
+ * its surface, the window its own bitmap unless it renders directly, so
+ * only the exposed part, returned in window space, needs to be drawn.
+ * Returns false if the window is not shown.
+ */
+
+bool SkiWin::scrollWindow(SkOSWindow* window, int dx, int dy,
+                          const SkIRect& rect, SkRegion* exposed)
+    {
+    sp<SkiWinView> view;
+
+    if (window == mWindowTop)
+        view = mContentViewTop;
+    else if (window == mWindowBot && mLogoBuf == NULL)
+        view = mContentViewBot;
+
+    if (view == NULL)
+        return false;
+
+    int x, y;
+    SkIRect r(rect);
+
+    if (!view->isDirectRendering())
+        window->getBitmap().scrollRect(&r, dx, dy);
+
+    view->getContentOffset(&x, &y);
+    r.offset(x, y);
+
+    view->scroll(dx, dy, r, exposed);
+    exposed->translate(-x, -y);
+
+    scheduleFrame();
+
+    return true;
+    }
+
+void SkiWin::invalidateTitle(SkOSWindow* window)
+    {
+    sp<SkiWinView> view;
+
+    if (window == mWindowTop)
+        view = mTitleViewTop;
+    else if (window == mWindowBot && mLogoBuf == NULL)
+        view = mTitleViewBot;
+
+    if (view == NULL)
+        return;
+
+    view->invalidate();
+
+    scheduleFrame();
+    }
+
+bool SkiWin::android()
+    {
+    mWindowTop->resize(320, 150);
+    mWindowMid->resize(320, 150);
+    mWindowBot->resize(320, 150);
+    mWindowMid->update(NULL);
+
+    mPageBuf = SkiWinURLResourceGet("www.baidu.com", &mPageBufLen);
+
+    if (mPageBuf == NULL) mPageBuf = (char *)gText;
+
+    layoutPage();
+
+    mLogoBuf = SkiWinURLResourceGet("www.baidu.com/img/bdlogo.gif", &mLogoBufLen);
+
+    if (mLogoBuf != NULL)
+        {
+        sp<SkiWinFramePack> pack = new SkiWinFramePack();
+
+        // prefer a prebuilt frame pack, it needs no reading or decoding
+        if (pack->open(SCREEN_VIDEO_PACK) == NO_ERROR)
+            mVideoSource = pack;
+        else
+            mVideoSource = new SkiWinVideoPlayer(SCREEN_VIDEO_PATTERN,
+                                                 SCREEN_VIDEO_DECODERS,
+                                                 SCREEN_VIDEO_DEPTH,
+                                                 SCREEN_VIDEO_FRAME_INTERVAL);
+
+        mVideoSource->setFrameReadyCallback(SkiWinVideoFrameReady, this);
+        mVideoSource->start();
+        }
+
+    int workers = sysconf(_SC_NPROCESSORS_ONLN);
+    char value[PROPERTY_VALUE_MAX];
+    Vector< sp<SkiWinView> > views;
+
+    mWindowManager->getWindows(&views);
+
+    if (workers > int(views.size()))
+        workers = views.size();
+
+    if (property_get(RENDER_THREADS_PROP_NAME, value, NULL) > 0)
+        workers = atoi(value) + 1;
+
+    if (workers > 1)
+        mFrameExecutor.start(workers - 1);
+
+    // resources arrived, everything needs to be drawn with them
+    for (size_t i = 0; i < views.size(); i++)
+        views[i]->invalidate();
+
+    do
+        {
+        nsecs_t timeout = EXIT_POLL_INTERVAL;
+
+        if (mVideoSource != NULL)
+            {
+            // the screen video is the only content that changes by itself
+            nsecs_t now = systemTime();
+            nsecs_t next = mVideoSource->getNextFrameTime();
+
+            if (next <= now && mVideoSource->acquireFrame(now, &mVideoFrame))
+                {
+                mTitleViewBot->invalidate();
+                timeout = 0;
+                }
+            else if (next > now && next - now < timeout)
+                {
+                timeout = next - now;
+                }
+
+            // a late frame calls back as soon as it is decoded
+            }
+
+        timeout = nextTimeout(timeout, mAnimator->getNextStepTime());
+        timeout = nextTimeout(timeout, mPageScroller.getNextStepTime());
+
+        waitForFrame(timeout);
+
+        if (android_atomic_acquire_load(&mShowRequested))
+            {
+            android_atomic_release_store(0, &mShowRequested);
+            show();
+            }
+
+        // input first, so the frame shows the effect of all of it
+        dispatchInput();
+
+        // animations only go through transactions, nothing is redrawn
+        mAnimator->step(systemTime());
+
+        int scroll;
+
+        // a drag or fling moved the page, the pixels on the screen move
+        // along and only what comes into view is drawn
+        if (mPageScroller.step(systemTime(), &scroll))
+            {
+            SkIRect bounds = mContentViewMid->getBounds();
+            SkRegion exposed;
+
+            mContentViewMid->scroll(0, mPageScroll - scroll,
+                                    SkIRect::MakeWH(bounds.width(),
+                                                    bounds.height()),
+                                    &exposed);
+            mPageScroll = scroll;
+            }
+
+        drawFrame();
+
+        // render what the page is about to scroll to, after the frame is
+        // out, a few tiles at a time
+        SkIRect viewport = mContentViewMid->getBounds();
+
+        viewport.offsetTo(0, mPageScroll);
+
+        mPageTiles.prefetch(viewport, mPageScroller.getDirection(),
+                            PAGE_PREFETCH_TILES);
+
+        checkExit();
+        }
+    while (!exitPending());
+
+    mFrameExecutor.stop();
+
+    ALOGD("input: %u moves in %u dispatches, %u events dropped",
+          mInputMoves, mInputMoveDispatches, mInputQueue.getDropped());
+
+    mImageCache.dump();
+    mTextLayoutCache.dump();
+    mPageTiles.dump();
+    mWindowManager->dump();
+
+    if (mVideoSource != NULL)
+        {
+        mVideoSource->stop();
+
+        ALOGD("screen video: %u frames dropped, %u loops",
+              mVideoSource->getDroppedFrames(), mVideoSource->getLoops());
+        }
+
+    return false;
+    }
+
+/**
+ * updateFocusView - Give focus to the window under a touch.
+ *
+ * The topmost window there takes it if it accepts input, a window that
+ * does not still keeps the touch from windows below it.
+ */
+
+sp<SkiWinView> SkiWin::updateFocusView(int x, int y)
+    {
+    sp<SkiWinView> view = mWindowManager->findWindowAt(x, y);
+
+    if (view != NULL && view->isFocusable())
+        mFocusView = view;
+    else
+        mFocusView = NULL;
+
+    return mFocusView;
+    }
+
+sp<SkiWinView> SkiWin::getFocusView()
+    {
+    return mFocusView;
+    }
+
+sp<SkiWinWindowManager> SkiWin::getWindowManager()
+    {
+    return mWindowManager;
+    }
+
+/**
+ * hide - Fade all views out and hide them.
+ *
+ * SurfaceFlinger does the fading and scaling, the views are not redrawn.
+ */
+
+void SkiWin::hide(void)
+    {
+    Vector< sp<SkiWinView> > views;
+    SkiWinAnimator::State to;
+
+    mWindowManager->getWindows(&views);
+
+    to.x = 0;
+    to.y = 0;
+    to.alpha = 0.0f;
+    to.scale = HIDE_SCALE;
+
+    for (size_t i = 0; i < views.size(); i++)
+        {
+        if (!views[i]->isVisible())
+            continue;
+
+        mAnimator->animate(views[i],
+                           SkiWinAnimator::ANIMATE_ALPHA |
+                           SkiWinAnimator::ANIMATE_SCALE,
+                           NULL, to, HIDE_DURATION,
+                           SkiWinAnimator::FLAG_HIDE_AFTER);
+        }
+    }
+
+/**
+ * requestShow - Have the SkiWin thread show the views before its next frame.
+ *
+ * Only stores a flag and writes to the pump's eventfd, so it can be called
+ * from a signal handler. show() itself takes locks the SkiWin thread may
+ * be holding.
+ */
+
+void SkiWin::requestShow(void)
+    {
+    android_atomic_release_store(1, &mShowRequested);
+
+    SkiWinEventPump::get()->wake();
+    }
+
+/**
+ * show - Show all views again, fading them in.
+ *
+ * SkiWin thread only.
+ */
 
 void SkiWin::show(void)
     {
-    mTitleViewTop->show();
-    mTitleViewBot->show();
-    mContentViewTop->show();
-    mContentViewMid->show();
-    mContentViewBot->show();
+    Vector< sp<SkiWinView> > views;
+
+    mWindowManager->getWindows(&views);
+
+    for (size_t i = 0; i < views.size(); i++)
+        {
+        SkiWinAnimator::State from, to;
+
+        SkiWinAnimator::getState(views[i], &to);
+
+        // a hidden view comes in from where hiding took it
+        if (!views[i]->isVisible())
+            {
+            from = to;
+            from.alpha = 0.0f;
+            from.scale = HIDE_SCALE;
+            }
+        else
+            {
+            // one still fading out turns around where it is
+            from = to;
+            }
+
+        to.alpha = 1.0f;
+        to.scale = 1.0f;
+
+        mAnimator->animate(views[i],
+                           SkiWinAnimator::ANIMATE_ALPHA |
+                           SkiWinAnimator::ANIMATE_SCALE,
+                           &from, to, SHOW_DURATION,
+                           SkiWinAnimator::FLAG_SHOW_FIRST);
+        }
     }
 
 void SkiWin::checkExit()
@@ -44,8 +44,22 @@
 #include "SkShader.h"
 #include <SkiaSamples/SampleApp.h>
 
+#include "SkiWinAnimator.h"
 #include "SkiWinEventListener.h"
+#include "SkiWinEventPump.h"
+#include "SkiWinImageCache.h"
+#include "SkiWinInputQueue.h"
+#include "SkiWinSurfaceBackend.h"
+#include "SkiWinTextLayout.h"
+#include "SkiWinTransaction.h"
+#include "SkiWinFrameExecutor.h"
+#include "SkiWinFrameStats.h"
+#include "SkiWinFramePack.h"
+#include "SkiWinScroller.h"
+#include "SkiWinTileCache.h"
+#include "SkiWinVideoPlayer.h"
 #include "SkiWinView.h"
+#include "SkiWinWindowManager.h"
 
 extern char * SkiWinURLResourceGet(const char * url, size_t * bufferLen);
 
@@ -76,23 +90,65 @@ class SkiWin : public Thread, public IBinder::DeathRecipient
         sp<SkiWinView> getFocusView();
         void hide(void);
         void show(void);
+        void requestShow(void);
+
+        void invalidateWindow(SkOSWindow* window, const SkIRect& rect);
+        void invalidateTitle(SkOSWindow* window);
+        bool scrollWindow(SkOSWindow* window, int dx, int dy,
+                          const SkIRect& rect, SkRegion* exposed);
+        void scheduleFrame(void);
+        void queueInput(const SkiWinInputEvent& event);
+        bool isInputQueueFull();
+        const Vector<SkiWinMotionSample>& getMotionHistory();
+
+        sp<SkiWinWindowManager> getWindowManager();
         
     private:
         virtual bool        threadLoop();
         virtual status_t    readyToRun();
         virtual void        onFirstRef();
         virtual void        binderDied(const wp<IBinder>& who);
-        void drawText(SkCanvas* canvas, 
-                      SkScalar w, SkScalar h, 
-                      SkColor fg, SkColor bg,
-                      const char text[]);
-        void drawImage(SkCanvas* canvas, const void* buffer, size_t size);
+        void dispatchInput();
+        void dispatchKey(const SkiWinInputEvent& event);
+        void dispatchMotion(const SkiWinInputEvent& event);
+        void dispatchTouch(int32_t id, int32_t x, int32_t y,
+                           SkView::Click::State state);
+        void cancelInput();
+        size_t recordInput(int metric, size_t first, size_t last);
+        size_t inputDispatched(size_t first, size_t last);
+        void recordInputShown(const sp<SkiWinView>& view);
+        bool scrollPage(const SkiWinInputEvent& event,
+                        SkView::Click::State state);
+        void layoutPage();
+        static void drawPageTile(void* context, SkCanvas* canvas,
+                                 const SkIRect& area);
+        void drawImage(SkCanvas* canvas, const SkBitmap& bitmap);
+
+        void drawTitleTop(SkCanvas* canvas);
+        void drawTitleBot(SkCanvas* canvas);
+        void drawContentTop(SkCanvas* canvas);
+        void drawContentMid(SkCanvas* canvas);
+        void drawContentBot(SkCanvas* canvas);
+        void drawWindow(const sp<SkiWinView>& view, SkOSWindow* window,
+                        SkCanvas* canvas);
+        void drawView(const sp<SkiWinView>& view, SkCanvas* canvas);
+        static void drawViewTask(void* context, size_t index);
+        bool shouldFlatten(const Vector< sp<SkiWinView> >& views);
+        bool updateFlatView(const SkIRect& bounds, PixelFormat format);
+        void setFlattened(const Vector< sp<SkiWinView> >& views,
+                          bool flattened);
+        void drawLayeredFrame(const Vector< sp<SkiWinView> >& views);
+        void drawFlattenedFrame(const Vector< sp<SkiWinView> >& views);
+        void drawFrame();
+        void waitForFrame(nsecs_t timeout);
 
         bool android();
 
         void checkExit();
 
-        sp<SurfaceComposerClient>       mSession;
+        sp<SkiWinSurfaceBackend>        mBackend;
+        sp<SkiWinWindowManager>         mWindowManager;
+        sp<SkiWinAnimator>              mAnimator;
 
         int         mWidth;
         int         mHeight;      
@@ -102,12 +158,118 @@ class SkiWin : public Thread, public IBinder::DeathRecipient
         sp<SkiWinView> mContentViewTop;
         sp<SkiWinView> mContentViewMid;
         sp<SkiWinView> mContentViewBot;
-
         
         sp<SkiWinView> mFocusView;
+
+        // set whenever a view picks up damage, cleared by the SkiWin thread
+        volatile int32_t mFramePending;
+
+        // set by SIGCONT, the SkiWin thread shows the views
+        volatile int32_t mShowRequested;
+
+        char * mPageBuf;
+        size_t mPageBufLen;
+        char * mLogoBuf;
+        size_t mLogoBufLen;
+
+        // decoded logo and any other image drawn more than once
+        SkiWinImageCache mImageCache;
+
+        // shaped page text and titles
+        SkiWinTextLayoutCache mTextLayoutCache;
+
+        // a run of the page in one text size, top in page space
+        struct PageBlock
+            {
+            sp<SkiWinTextLayout> layout;
+            SkScalar textSize;
+            SkScalar top;
+            };
+
+        // the page laid out in full, the middle view scrolls through it
+        Vector<PageBlock> mPageBlocks;
+        int mPageHeight;
+        SkiWinTileCache mPageTiles;
+        SkiWinScroller mPageScroller;
+
+        // page position the current frame is drawn at
+        int mPageScroll;
+
+        // a touch that went down on the page is scrolling it, with the
+        // pointer it went down with, -1 once that one has lifted
+        bool mPageDragging;
+        int32_t mPageDragPointer;
+
+        // input from the reader thread, dispatched on the SkiWin thread
+        SkiWinInputQueue mInputQueue;
+
+        // set when the queue was full for anything but a move, the touch
+        // it belonged to is cancelled
+        volatile int32_t mInputLost;
+
+        // pointers down in the focused window, at their last position
+        KeyedVector<int32_t, SkIPoint> mTouchDown;
+
+        // moves folded into the one being dispatched
+        Vector<SkiWinMotionSample> mMotionHistory;
+
+        // when the input being dispatched happened
+        Vector<nsecs_t> mInputTimes;
+
+        // the view the event just dispatched went to, if any
+        sp<SkiWinView> mInputTarget;
+
+        // input waiting for its view to post, until the end of the frame
+        struct PendingInput
+            {
+            sp<SkiWinView> view;
+            nsecs_t eventTime;
+            };
+        Vector<PendingInput> mInputShown;
+        uint32_t mInputMoves;
+        uint32_t mInputMoveDispatches;
+
+        // screen video played back in the bottom title view
+        sp<SkiWinFrameSource> mVideoSource;
+        SkBitmap mVideoFrame;
+
+        // draws the damaged views of a frame concurrently
+        SkiWinFrameExecutor mFrameExecutor;
+        Vector< sp<SkiWinView> > mFrameViews;
+        Vector<SkRegion> mFrameDamage;
+        Vector<bool> mFrameLocked;
+
+        // part of every window not covered by those above, in view space
+        Vector<SkRegion> mFrameVisible;
+
+        enum
+            {
+            FLATTEN_NEVER,
+            FLATTEN_AUTO,
+            FLATTEN_ALWAYS
+            };
+
+        // a view as last drawn into the flattened surface, screen space
+        struct FlatWindow
+            {
+            sp<SkiWinView> view;
+            SkIRect bounds;
+            SkRegion visible;
+            };
+
+        // all views composed into one surface instead of by SurfaceFlinger
+        int mFlattenMode;
+        bool mFlattened;
+        bool mFlatReleasePending;
+        sp<SkiWinView> mFlatView;
+        SkBitmap mFlatBuffer;
+        Vector<FlatWindow> mFlatWindows;
+        SkRegion mFlatBackground;
         
     };
 
+extern SkiWin * gSkiWin;
+
 // ---------------------------------------------------------------------------
 
 }; // namespace android
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define LOG_TAG "SkiWinAnimator"
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include "SkiWinAnimator.h"
+#include "SkiWinEventPump.h"
+#include "SkiWinTransaction.h"
+
+namespace android
+{
+
+// slow in, slow out, as control points of a unit cubic
+static const SkScalar gEaseInOut[4] =
+    {
+    SkFloatToScalar(0.42f), 0, SkFloatToScalar(0.58f), SK_Scalar1
+    };
+
+/*
+ * Scaling happens about the surface's top left corner, so a window scaled
+ * about its center is moved by this much.
+ */
+
+static int centerOffset(int size, float scale)
+    {
+    return int(floorf(size * (1.0f - scale) / 2 + 0.5f));
+    }
+
+SkiWinAnimator::SkiWinAnimator(const sp<SkiWinSurfaceBackend>& backend,
+                               nsecs_t frameInterval) :
+    mBackend(backend), mFrameInterval(frameInterval), mNextStep(0)
+    {
+    }
+
+SkiWinAnimator::~SkiWinAnimator()
+    {
+    for (size_t i = 0; i < mAnimations.size(); i++)
+        delete mAnimations[i];
+    }
+
+/**
+ * getState - Where a window is, as an animation sees it.
+ *
+ * The position is that of the unscaled window, whatever scale it is shown
+ * at right now.
+ */
+
+void SkiWinAnimator::getState(const sp<SkiWinView>& view, State* state)
+    {
+    SkIRect bounds = view->getBounds();
+    float matrix[4];
+
+    view->getMatrix(matrix);
+
+    state->scale = matrix[0];
+    state->alpha = view->getAlpha();
+    state->x = bounds.fLeft - centerOffset(bounds.width(), state->scale);
+    state->y = bounds.fTop - centerOffset(bounds.height(), state->scale);
+    }
+
+/**
+ * animate - Move the properties in what from one state to another.
+ *
+ * from NULL starts where the window is. An animation already running on
+ * the window is replaced, the new one carries on from where that left it
+ * unless from says otherwise.
+ */
+
+void SkiWinAnimator::animate(const sp<SkiWinView>& view, uint32_t what,
+                             const State* from, const State& to,
+                             nsecs_t duration, uint32_t flags)
+    {
+    State start;
+
+    if (from != NULL)
+        start = *from;
+    else
+        getState(view, &start);
+
+    SkScalar begin[VALUE_COUNT];
+    SkScalar end[VALUE_COUNT];
+
+    begin[VALUE_X] = SkIntToScalar(start.x);
+    begin[VALUE_Y] = SkIntToScalar(start.y);
+    begin[VALUE_ALPHA] = SkFloatToScalar(start.alpha);
+    begin[VALUE_SCALE] = SkFloatToScalar(start.scale);
+
+    memcpy(end, begin, sizeof(end));
+
+    if (what & ANIMATE_POSITION)
+        {
+        end[VALUE_X] = SkIntToScalar(to.x);
+        end[VALUE_Y] = SkIntToScalar(to.y);
+        }
+
+    if (what & ANIMATE_ALPHA)
+        end[VALUE_ALPHA] = SkFloatToScalar(to.alpha);
+
+    if (what & ANIMATE_SCALE)
+        end[VALUE_SCALE] = SkFloatToScalar(to.scale);
+
+    SkMSec now = SkMSec(ns2ms(systemTime()));
+    SkMSec length = SkMSec(ns2ms(duration));
+
+    if (length < 1)
+        length = 1;
+
+    Animation* animation = new Animation;
+
+    animation->view = view;
+    animation->what = what;
+    animation->flags = flags;
+    animation->interpolator.reset(VALUE_COUNT, 2);
+    animation->interpolator.setKeyFrame(0, now, begin, gEaseInOut);
+    animation->interpolator.setKeyFrame(1, now + length, end, gEaseInOut);
+
+        {
+        Mutex::Autolock _l(mLock);
+        ssize_t index = indexOfLocked(view);
+
+        if (index >= 0)
+            {
+            delete mAnimations[index];
+            mAnimations.removeAt(index);
+            }
+
+        // the first step of an animation is due right away
+        if (mAnimations.isEmpty())
+            mNextStep = 0;
+
+        mAnimations.add(animation);
+        }
+
+    SkiWinEventPump::get()->wake();
+    }
+
+void SkiWinAnimator::cancel(const sp<SkiWinView>& view)
+    {
+    Mutex::Autolock _l(mLock);
+    ssize_t index = indexOfLocked(view);
+
+    if (index < 0)
+        return;
+
+    delete mAnimations[index];
+    mAnimations.removeAt(index);
+    }
+
+ssize_t SkiWinAnimator::indexOfLocked(const sp<SkiWinView>& view)
+    {
+    for (size_t i = 0; i < mAnimations.size(); i++)
+        {
+        if (mAnimations[i]->view == view)
+            return i;
+        }
+
+    return -1;
+    }
+
+bool SkiWinAnimator::isAnimating()
+    {
+    Mutex::Autolock _l(mLock);
+
+    return !mAnimations.isEmpty();
+    }
+
+/**
+ * getNextStepTime - When step() has something to do, LLONG_MAX if never.
+ */
+
+nsecs_t SkiWinAnimator::getNextStepTime()
+    {
+    Mutex::Autolock _l(mLock);
+
+    return mAnimations.isEmpty() ? LLONG_MAX : mNextStep;
+    }
+
+/**
+ * step - Commit the state of all animations at now in one transaction.
+ *
+ * Steps are at least a frame interval apart, an early call does nothing,
+ * so being woken by the transaction of a step does not step again.
+ */
+
+void SkiWinAnimator::step(nsecs_t now)
+    {
+    SkiWinTransaction t(mBackend);
+    Vector<Animation*> finished;
+
+        {
+        Mutex::Autolock _l(mLock);
+
+        if (mAnimations.isEmpty() || now < mNextStep)
+            return;
+
+        SkMSec msec = SkMSec(ns2ms(now));
+
+        for (size_t i = 0; i < mAnimations.size(); )
+            {
+            Animation* animation = mAnimations[i];
+            const sp<SkiWinView>& view = animation->view;
+            uint32_t what = animation->what;
+            SkScalar values[VALUE_COUNT];
+
+            SkInterpolator::Result result =
+                animation->interpolator.timeToValues(msec, values);
+            bool done = result == SkInterpolator::kFreezeEnd_Result;
+
+            if (animation->flags & FLAG_SHOW_FIRST)
+                {
+                t.setVisible(view, true);
+                animation->flags &= ~FLAG_SHOW_FIRST;
+                }
+
+            if (done && (animation->flags & FLAG_HIDE_AFTER))
+                {
+                t.setVisible(view, false);
+
+                values[VALUE_ALPHA] = SK_Scalar1;
+                values[VALUE_SCALE] = SK_Scalar1;
+                what |= ANIMATE_ALPHA | ANIMATE_SCALE;
+                }
+
+            SkIRect bounds = view->getBounds();
+            float scale = SkScalarToFloat(values[VALUE_SCALE]);
+
+            if (what & (ANIMATE_POSITION | ANIMATE_SCALE))
+                {
+                int x = SkScalarRound(values[VALUE_X]);
+                int y = SkScalarRound(values[VALUE_Y]);
+
+                t.setPosition(view, x + centerOffset(bounds.width(), scale),
+                              y + centerOffset(bounds.height(), scale));
+                }
+
+            if (what & ANIMATE_ALPHA)
+                t.setAlpha(view, SkScalarToFloat(values[VALUE_ALPHA]));
+
+            if (what & ANIMATE_SCALE)
+                t.setMatrix(view, scale, 0.0f, 0.0f, scale);
+
+            if (done)
+                {
+                finished.add(animation);
+                mAnimations.removeAt(i);
+                continue;
+                }
+
+            i++;
+            }
+
+        mNextStep = now + mFrameInterval;
+        }
+
+    t.apply();
+
+    for (size_t i = 0; i < finished.size(); i++)
+        delete finished[i];
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
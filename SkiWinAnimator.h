@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_SKIWIN_ANIMATOR_H
+#define ANDROID_SKIWIN_ANIMATOR_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/RefBase.h>
+#include <utils/threads.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+#include <SkInterpolator.h>
+
+#include "SkiWinSurfaceBackend.h"
+#include "SkiWinView.h"
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * SkiWinAnimator - Window animations done by SurfaceFlinger alone.
+ *
+ * Position, alpha and a scale about the window's center are interpolated
+ * on a frame clock and committed for all animating windows in one
+ * transaction per step. The content buffers are never touched, so an
+ * animation costs a transaction per frame rather than a redraw.
+ *
+ * The SkiWin thread calls step() when getNextStepTime() comes, any thread
+ * may start or cancel animations.
+ */
+
+class SkiWinAnimator : public RefBase
+    {
+    public:
+        enum
+            {
+            ANIMATE_POSITION = 0x01,
+            ANIMATE_ALPHA    = 0x02,
+            ANIMATE_SCALE    = 0x04
+            };
+
+        enum
+            {
+            // shown along with the first step
+            FLAG_SHOW_FIRST  = 0x01,
+            // hidden at the end, and put back opaque and unscaled
+            FLAG_HIDE_AFTER  = 0x02
+            };
+
+        struct State
+            {
+            int x;
+            int y;
+            float alpha;
+            float scale;
+            };
+
+        SkiWinAnimator(const sp<SkiWinSurfaceBackend>& backend,
+                       nsecs_t frameInterval);
+        virtual ~SkiWinAnimator();
+
+        static void getState(const sp<SkiWinView>& view, State* state);
+
+        void animate(const sp<SkiWinView>& view, uint32_t what,
+                     const State* from, const State& to,
+                     nsecs_t duration, uint32_t flags = 0);
+        void cancel(const sp<SkiWinView>& view);
+
+        bool isAnimating();
+        nsecs_t getNextStepTime();
+        void step(nsecs_t now);
+
+    private:
+        enum
+            {
+            VALUE_X,
+            VALUE_Y,
+            VALUE_ALPHA,
+            VALUE_SCALE,
+            VALUE_COUNT
+            };
+
+        struct Animation
+            {
+            sp<SkiWinView> view;
+            uint32_t what;
+            uint32_t flags;
+            SkInterpolator interpolator;
+            };
+
+        ssize_t indexOfLocked(const sp<SkiWinView>& view);
+
+        sp<SkiWinSurfaceBackend> mBackend;
+        nsecs_t mFrameInterval;
+
+        Mutex mLock;
+        Vector<Animation*> mAnimations;
+        nsecs_t mNextStep;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_ANIMATOR_H
@@ -3,15 +3,27 @@
 //#define LOG_NDEBUG 0
 
 
+#include <stdlib.h>
+
 #include <SkWindow.h>
 #include <SkApplication.h>
 #include <cutils/log.h>
+#include <cutils/properties.h>
 #include "SkiWinEventListener.h"
+#include "SkiWinInputTrace.h"
 #include <gui/ISurfaceComposer.h>
 #include <gui/SurfaceComposerClient.h>
 
 #define REPORT_FUNCTION() ALOGV("%s\n", __PRETTY_FUNCTION__);
 
+/*
+ * Trace file the keys and touches are recorded to, and one to replay in
+ * place of the input devices, at the recorded pace or back to back.
+ */
+#define INPUT_RECORD_PROP_NAME "debug.skiwin.input.record"
+#define INPUT_REPLAY_PROP_NAME "debug.skiwin.input.replay"
+#define INPUT_REPLAY_FAST_PROP_NAME "debug.skiwin.input.replay.fast"
+
 namespace android
 {
 
@@ -152,8 +164,10 @@ class SkiWinInputListener : public InputListenerInterface
     {
     public:
 
-        SkiWinInputListener(SkiWinEventCallback* callback) :
-            callback(callback)
+        SkiWinInputListener(SkiWinEventCallback* callback,
+                            SkiWinInputRecorder* recorder) :
+            callback(callback),
+            recorder(recorder)
             {
             }
 
@@ -167,6 +181,7 @@ class SkiWinInputListener : public InputListenerInterface
             {
             REPORT_FUNCTION();
 
+            recorder->recordKey(args);
             callback->pfNotifyKey(args, callback->context);
             }
 
@@ -174,6 +189,7 @@ class SkiWinInputListener : public InputListenerInterface
             {
             REPORT_FUNCTION();
 
+            recorder->recordMotion(args);
             callback->pfNotifyMotion(args, callback->context);
             }
 
@@ -193,6 +209,7 @@ class SkiWinInputListener : public InputListenerInterface
     private:
 
         SkiWinEventCallback* callback;
+        SkiWinInputRecorder* recorder;
 
     };
 
@@ -220,33 +237,93 @@ class SkiWinInputManager : public RefBase
     public:
 
         SkiWinInputManager(SkiWinEventCallback* callback, SkiWinInputConfiguration* configuration)
-            : mLooper(new Looper(false)),
-              mLooperThread(new SkiWinInputListenerLooperThread(mLooper)),
-              mEventHub(new EventHub()),
-              mInputReaderPolicy(new SkiWinInputReaderPolicyInterface(configuration, mLooper)),
-              mInputListener(new SkiWinInputListener(callback)),
-              mInputReader(new InputReader(
-                               mEventHub,
-                               mInputReaderPolicy,
-                               mInputListener)),
-              mInputReaderThread(new InputReaderThread(mInputReader))
+            : mInputListener(new SkiWinInputListener(callback, &mRecorder))
             {
+            char value[PROPERTY_VALUE_MAX];
+            status_t err;
+
+            if (property_get(INPUT_RECORD_PROP_NAME, value, NULL) > 0)
+                {
+                err = mRecorder.open(value);
+                ALOGE_IF(err != NO_ERROR, "cannot record input to %s (%d)",
+                         value, err);
+                }
+
+            // a replay needs no devices, no reader and no display
+            if (property_get(INPUT_REPLAY_PROP_NAME, value, NULL) > 0)
+                {
+                char fast[PROPERTY_VALUE_MAX];
+
+                property_get(INPUT_REPLAY_FAST_PROP_NAME, fast, "0");
+
+                sp<SkiWinInputPlayer> player =
+                    new SkiWinInputPlayer(mInputListener, callback,
+                                          atoi(fast) != 0);
+
+                err = player->open(value);
+                if (err == NO_ERROR)
+                    {
+                    mInputPlayer = player;
+                    return;
+                    }
+
+                ALOGE("cannot replay input from %s (%d), reading the devices",
+                      value, err);
+                }
+
+            mLooper = new Looper(false);
+            mLooperThread = new SkiWinInputListenerLooperThread(mLooper);
+            mEventHub = new EventHub();
+            mInputReaderPolicy = new SkiWinInputReaderPolicyInterface(configuration, mLooper);
+            mInputReader = new InputReader(mEventHub,
+                                           mInputReaderPolicy,
+                                           mInputListener);
+            mInputReaderThread = new InputReaderThread(mInputReader);
             }
 
         ~SkiWinInputManager()
             {
-            mInputReaderThread->requestExitAndWait();
+            stop();
+            }
+
+        void run()
+            {
+            if (mInputPlayer != NULL)
+                {
+                mInputPlayer->run("SkiWinInputPlayer");
+                return;
+                }
+
+            mInputReaderThread->run();
+            mLooperThread->run();
+            }
+
+        void stop()
+            {
+            if (mInputReaderThread != NULL)
+                mInputReaderThread->requestExitAndWait();
+
+            if (mInputPlayer != NULL)
+                mInputPlayer->requestExitAndWait();
             }
 
+        // first, so it outlives the listener recording through it
+        SkiWinInputRecorder mRecorder;
+
+        sp<InputListenerInterface> mInputListener;
+
+        // the devices and their reader, none of them when replaying
         sp<Looper> mLooper;
         sp<SkiWinInputListenerLooperThread> mLooperThread;
 
         sp<EventHubInterface> mEventHub;
         sp<InputReaderPolicyInterface> mInputReaderPolicy;
-        sp<InputListenerInterface> mInputListener;
         sp<InputReaderInterface> mInputReader;
         sp<InputReaderThread> mInputReaderThread;
 
+        // stands in for all of the above when replaying
+        sp<SkiWinInputPlayer> mInputPlayer;
+
         Condition mWaitCondition;
         Mutex mWaitLock;
     };
@@ -260,19 +337,18 @@ void SkiWinInputManagerInit(SkiWinEventCallback* listener, SkiWinInputConfigurat
 
 void SkiWinInputManagerLoopOnce()
     {
-    gSkiWinInputManager->mInputReader->loopOnce();
+    if (gSkiWinInputManager->mInputReader != NULL)
+        gSkiWinInputManager->mInputReader->loopOnce();
     }
 
 void SkiWinInputManagerStart()
     {
-    gSkiWinInputManager->mInputReaderThread->run();
-    gSkiWinInputManager->mLooperThread->run();
+    gSkiWinInputManager->run();
     }
 
 void SkiWinInputManagerStartAndWait(bool* flag)
     {
-    gSkiWinInputManager->mInputReaderThread->run();
-    gSkiWinInputManager->mLooperThread->run();
+    gSkiWinInputManager->run();
 
     while (!*flag)
         {
@@ -284,7 +360,7 @@ void SkiWinInputManagerStartAndWait(bool* flag)
 
 void SkiWinInputManagerStop()
     {
-    gSkiWinInputManager->mInputReaderThread->requestExitAndWait();
+    gSkiWinInputManager->stop();
     }
 
 void SkiWinInputManagerExit()
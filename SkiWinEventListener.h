@@ -24,6 +24,7 @@ namespace android
 typedef void (*NotifyKeyCallback)(const NotifyKeyArgs* args, void* context);
 typedef void (*NotifyMotionCallback)(const NotifyMotionArgs* args, void* context);
 typedef void (*NotifySwitchCallback)(const NotifySwitchArgs* args, void* context);
+typedef bool (*InputQueueFullCallback)(void* context);
 
 struct SkiWinEventCallback
     {
@@ -32,6 +33,9 @@ struct SkiWinEventCallback
     NotifyMotionCallback pfNotifyMotion;
     NotifySwitchCallback pfNotifySwitch;
 
+    // replaying input waits while this says nothing more can be taken
+    InputQueueFullCallback pfInputQueueFull;
+
     void* context;
     };
 
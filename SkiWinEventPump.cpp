@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinEventPump"
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include <cutils/atomic.h>
+#include <utils/Log.h>
+#include <utils/Timers.h>
+
+#include <SkEvent.h>
+
+#include "SkiWinEventPump.h"
+
+// upper bound of SkEvents handled per wakeup, so frames are not starved
+#define MAX_EVENTS_PER_DISPATCH 64
+
+namespace android
+{
+
+SkiWinEventPump* SkiWinEventPump::get()
+    {
+    static SkiWinEventPump sPump;
+
+    return &sPump;
+    }
+
+SkiWinEventPump::SkiWinEventPump()
+    {
+    mWakeFd = eventfd(0, EFD_NONBLOCK);
+
+    ALOGE_IF(mWakeFd < 0, "eventfd failed (%s)", strerror(errno));
+
+    mTimerDeadline = 0;
+    mServiceThread = 0;
+    mQueueNonEmpty = 0;
+    }
+
+SkiWinEventPump::~SkiWinEventPump()
+    {
+    if (mWakeFd >= 0)
+        close(mWakeFd);
+    }
+
+/**
+ * wake - Make a pending or the next waitAndDispatch() return immediately.
+ *
+ * Safe to call from any thread.
+ */
+
+void SkiWinEventPump::wake()
+    {
+    uint64_t inc = 1;
+
+    if (write(mWakeFd, &inc, sizeof(inc)) != sizeof(inc) && errno != EAGAIN)
+        {
+        ALOGW("wake failed (%s)", strerror(errno));
+        }
+    }
+
+void SkiWinEventPump::signalNonEmptyQueue()
+    {
+    android_atomic_release_store(1, &mQueueNonEmpty);
+
+    wake();
+    }
+
+/**
+ * signalQueueTimer - Arm the timer for the earliest delayed SkEvent.
+ *
+ * SkEvent::ServiceQueueTimer() reports "no more delayed events" with a delay
+ * of 0, while SkEvent::postTime() may pass 0 for an event that is already
+ * due. The two are told apart by the calling thread.
+ */
+
+void SkiWinEventPump::signalQueueTimer(SkMSec delay)
+    {
+    Mutex::Autolock _l(mTimerLock);
+
+    if (delay == 0 && mServiceThread == pthread_self())
+        {
+        mTimerDeadline = 0;
+        return;
+        }
+
+    mTimerDeadline = systemTime() + ms2ns(delay);
+
+    wake();
+    }
+
+void SkiWinEventPump::dispatch()
+    {
+    bool serviceTimer = false;
+
+        {
+        Mutex::Autolock _l(mTimerLock);
+
+        if (mTimerDeadline != 0 && mTimerDeadline <= systemTime())
+            {
+            mTimerDeadline = 0;
+            mServiceThread = pthread_self();
+            serviceTimer = true;
+            }
+        }
+
+    if (serviceTimer)
+        {
+        // moves due events to the queue, then re-arms us through
+        // SkEvent::SignalQueueTimer()
+        SkEvent::ServiceQueueTimer();
+
+        Mutex::Autolock _l(mTimerLock);
+        mServiceThread = 0;
+        }
+
+    if (android_atomic_acquire_cas(1, 0, &mQueueNonEmpty) == 0)
+        {
+        int count = 0;
+
+        while (SkEvent::ProcessEvent())
+            {
+            if (++count >= MAX_EVENTS_PER_DISPATCH)
+                {
+                // leave the rest for the next round
+                signalNonEmptyQueue();
+                break;
+                }
+            }
+        }
+    }
+
+/**
+ * waitAndDispatch - Block the SkiWin thread until there is work to do.
+ *
+ * Returns after at most timeout nanoseconds, or earlier when woken up or
+ * when the earliest delayed SkEvent is due. Any pending SkEvent is
+ * dispatched on the calling thread before returning.
+ */
+
+void SkiWinEventPump::waitAndDispatch(nsecs_t timeout)
+    {
+    nsecs_t now = systemTime();
+    nsecs_t deadline = now + timeout;
+
+        {
+        Mutex::Autolock _l(mTimerLock);
+
+        if (mTimerDeadline != 0 && mTimerDeadline < deadline)
+            deadline = mTimerDeadline;
+        }
+
+    if (timeout > 0 && deadline > now)
+        {
+        struct pollfd pfd;
+
+        pfd.fd = mWakeFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ret = poll(&pfd, 1, toMillisecondTimeoutDelay(now, deadline));
+
+        if (ret < 0 && errno != EINTR)
+            {
+            ALOGW("poll failed (%s)", strerror(errno));
+            }
+        }
+
+    uint64_t counter;
+
+    // drain the eventfd so the next wait blocks again
+    read(mWakeFd, &counter, sizeof(counter));
+
+    dispatch();
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_EVENT_PUMP_H
+#define ANDROID_SKIWIN_EVENT_PUMP_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <pthread.h>
+
+#include <utils/threads.h>
+#include <utils/Timers.h>
+
+#include <SkTypes.h>
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * SkiWinEventPump - Wakeup source and SkEvent dispatcher of the SkiWin thread.
+ *
+ * SkEvent::SignalNonEmptyQueue() and SkEvent::SignalQueueTimer() are routed
+ * here from any thread. The SkiWin thread blocks in waitAndDispatch(), which
+ * returns when the event queue becomes non-empty, the earliest delayed event
+ * is due, someone calls wake() (e.g. because a view got damage), or the
+ * timeout expires. Pending SkEvents are always dispatched on the SkiWin
+ * thread before it returns.
+ */
+
+class SkiWinEventPump
+    {
+    public:
+        static SkiWinEventPump* get();
+
+        void wake();
+        void signalNonEmptyQueue();
+        void signalQueueTimer(SkMSec delay);
+
+        void waitAndDispatch(nsecs_t timeout);
+
+    private:
+        SkiWinEventPump();
+        ~SkiWinEventPump();
+
+        void dispatch();
+
+        int mWakeFd;
+
+        // absolute time of the earliest delayed SkEvent, 0 if none
+        Mutex mTimerLock;
+        nsecs_t mTimerDeadline;
+        pthread_t mServiceThread;
+
+        volatile int32_t mQueueNonEmpty;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_EVENT_PUMP_H
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinFrameExecutor"
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include "SkiWinFrameExecutor.h"
+
+namespace android
+{
+
+SkiWinFrameExecutor::SkiWinFrameExecutor()
+    {
+    mStopping = false;
+    mTask = NULL;
+    mContext = NULL;
+    mCount = 0;
+    mNext = 0;
+    mPending = 0;
+    }
+
+SkiWinFrameExecutor::~SkiWinFrameExecutor()
+    {
+    stop();
+    }
+
+status_t SkiWinFrameExecutor::start(int workers)
+    {
+    status_t err = NO_ERROR;
+
+    for (int i = 0; i < workers; i++)
+        {
+        sp<WorkerThread> worker = new WorkerThread(this);
+
+        // same priority as the SkiWin thread, they draw its frame
+        err = worker->run("SkiWinFrameWorker", PRIORITY_DISPLAY);
+        if (err != NO_ERROR)
+            {
+            ALOGW("only %d of %d frame workers started", i, workers);
+            break;
+            }
+
+        mWorkers.add(worker);
+        }
+
+    return err;
+    }
+
+void SkiWinFrameExecutor::stop()
+    {
+        {
+        Mutex::Autolock _l(mLock);
+
+        mStopping = true;
+        mWorkAvailable.broadcast();
+        }
+
+    for (size_t i = 0; i < mWorkers.size(); i++)
+        mWorkers[i]->requestExitAndWait();
+
+    mWorkers.clear();
+
+    Mutex::Autolock _l(mLock);
+
+    mStopping = false;
+    }
+
+/**
+ * runTasks - Take and run tasks of the current frame until none is left.
+ *
+ * Called with mLock held, which is dropped while a task runs.
+ */
+
+void SkiWinFrameExecutor::runTasks()
+    {
+    while (mNext < mCount)
+        {
+        size_t index = mNext++;
+        FrameTask task = mTask;
+        void* context = mContext;
+
+        mLock.unlock();
+        task(context, index);
+        mLock.lock();
+
+        if (--mPending == 0)
+            mWorkDone.broadcast();
+        }
+    }
+
+bool SkiWinFrameExecutor::work()
+    {
+    Mutex::Autolock _l(mLock);
+
+    while (!mStopping && mNext >= mCount)
+        mWorkAvailable.wait(mLock);
+
+    if (mStopping)
+        return false;
+
+    runTasks();
+
+    return true;
+    }
+
+bool SkiWinFrameExecutor::WorkerThread::threadLoop()
+    {
+    return mExecutor->work();
+    }
+
+/**
+ * execute - Run task(context, 0) .. task(context, count - 1) concurrently.
+ *
+ * Returns when every task has completed.
+ */
+
+void SkiWinFrameExecutor::execute(FrameTask task, void* context, size_t count)
+    {
+    if (mWorkers.isEmpty() || count <= 1)
+        {
+        for (size_t i = 0; i < count; i++)
+            task(context, i);
+
+        return;
+        }
+
+    Mutex::Autolock _l(mLock);
+
+    mTask = task;
+    mContext = context;
+    mCount = count;
+    mNext = 0;
+    mPending = count;
+
+    mWorkAvailable.broadcast();
+
+    // the calling thread would only wait, so it takes tasks as well
+    runTasks();
+
+    while (mPending > 0)
+        mWorkDone.wait(mLock);
+
+    mTask = NULL;
+    mContext = NULL;
+    mCount = 0;
+    mNext = 0;
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_FRAME_EXECUTOR_H
+#define ANDROID_SKIWIN_FRAME_EXECUTOR_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+typedef void (*FrameTask)(void* context, size_t index);
+
+/*
+ * SkiWinFrameExecutor - Fixed pool of threads running the tasks of a frame.
+ *
+ * execute() hands out task indexes to the workers and to the calling
+ * thread, and returns once all of them have run, which is the barrier
+ * before the results of the frame are posted. Without workers, or with a
+ * single task, everything runs on the calling thread.
+ */
+
+class SkiWinFrameExecutor
+    {
+    public:
+        SkiWinFrameExecutor();
+        ~SkiWinFrameExecutor();
+
+        status_t start(int workers);
+        void stop();
+
+        size_t getWorkerCount() const
+            {
+            return mWorkers.size();
+            }
+
+        void execute(FrameTask task, void* context, size_t count);
+
+    private:
+        class WorkerThread : public Thread
+            {
+            public:
+                WorkerThread(SkiWinFrameExecutor* executor) :
+                    mExecutor(executor) {}
+            private:
+                virtual bool threadLoop();
+                SkiWinFrameExecutor* mExecutor;
+            };
+
+        bool work();
+        void runTasks();
+
+        Mutex mLock;
+        Condition mWorkAvailable;
+        Condition mWorkDone;
+        bool mStopping;
+
+        // the frame being executed, tasks below mNext are taken
+        FrameTask mTask;
+        void* mContext;
+        size_t mCount;
+        size_t mNext;
+        size_t mPending;
+
+        Vector< sp<WorkerThread> > mWorkers;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_FRAME_EXECUTOR_H
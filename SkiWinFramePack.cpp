@@ -0,0 +1,594 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinFramePack"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <utils/Log.h>
+
+#include <core/SkBitmap.h>
+
+#include "SkiWinFramePack.h"
+
+#ifndef PAGE_SIZE
+#define PAGE_SIZE 4096
+#endif
+
+#define RLE_RUN_FLAG    0x8000
+#define RLE_MAX_COUNT   0x7fff
+
+namespace android
+{
+
+static int bytesPerPixel(SkBitmap::Config config)
+    {
+    switch (config)
+        {
+        case SkBitmap::kRGB_565_Config:
+            return 2;
+        case SkBitmap::kARGB_8888_Config:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+/**
+ * SkiWinFramePackEncodeRLE - Run length encode count pixels of bpp bytes.
+ *
+ * Returns the encoded size, or 0 if the result would not fit in capacity
+ * bytes, in which case the frame is better stored raw.
+ */
+
+size_t SkiWinFramePackEncodeRLE(const void* pixels, size_t count, int bpp,
+                                uint8_t* out, size_t capacity)
+    {
+    const uint8_t* in = static_cast<const uint8_t*>(pixels);
+    uint8_t* start = out;
+    uint8_t* limit = out + capacity;
+    size_t i = 0;
+
+    while (i < count)
+        {
+        // measure the run starting here
+        size_t run = 1;
+
+        while (i + run < count && run < RLE_MAX_COUNT &&
+               memcmp(in + i * bpp, in + (i + run) * bpp, bpp) == 0)
+            run++;
+
+        if (run >= 2)
+            {
+            uint16_t token = RLE_RUN_FLAG | run;
+
+            if (out + sizeof(token) + bpp > limit)
+                return 0;
+
+            memcpy(out, &token, sizeof(token));
+            memcpy(out + sizeof(token), in + i * bpp, bpp);
+            out += sizeof(token) + bpp;
+            i += run;
+            continue;
+            }
+
+        // collect literals up to the next run of at least two pixels
+        size_t lit = 1;
+
+        while (i + lit < count && lit < RLE_MAX_COUNT &&
+               (i + lit + 1 >= count ||
+                memcmp(in + (i + lit) * bpp, in + (i + lit + 1) * bpp, bpp) != 0))
+            lit++;
+
+        uint16_t token = lit;
+
+        if (out + sizeof(token) + lit * bpp > limit)
+            return 0;
+
+        memcpy(out, &token, sizeof(token));
+        memcpy(out + sizeof(token), in + i * bpp, lit * bpp);
+        out += sizeof(token) + lit * bpp;
+        i += lit;
+        }
+
+    return out - start;
+    }
+
+/**
+ * SkiWinFramePackDecodeRLE - Expand a run length encoded frame.
+ *
+ * Returns false if the input is malformed or does not cover exactly
+ * count pixels.
+ */
+
+bool SkiWinFramePackDecodeRLE(const uint8_t* in, size_t size, int bpp,
+                              void* pixels, size_t count)
+    {
+    const uint8_t* end = in + size;
+    uint8_t* out = static_cast<uint8_t*>(pixels);
+    size_t done = 0;
+
+    while (in + sizeof(uint16_t) <= end)
+        {
+        uint16_t token;
+
+        memcpy(&token, in, sizeof(token));
+        in += sizeof(token);
+
+        size_t n = token & RLE_MAX_COUNT;
+
+        if (done + n > count)
+            return false;
+
+        if (token & RLE_RUN_FLAG)
+            {
+            if (in + bpp > end)
+                return false;
+
+            if (bpp == 2)
+                {
+                uint16_t pixel;
+                uint16_t* dst = reinterpret_cast<uint16_t*>(out);
+
+                memcpy(&pixel, in, sizeof(pixel));
+                for (size_t k = 0; k < n; k++)
+                    dst[k] = pixel;
+                }
+            else
+                {
+                uint32_t pixel;
+                uint32_t* dst = reinterpret_cast<uint32_t*>(out);
+
+                memcpy(&pixel, in, sizeof(pixel));
+                for (size_t k = 0; k < n; k++)
+                    dst[k] = pixel;
+                }
+
+            in += bpp;
+            }
+        else
+            {
+            if (in + n * bpp > end)
+                return false;
+
+            memcpy(out, in, n * bpp);
+            in += n * bpp;
+            }
+
+        out += n * bpp;
+        done += n;
+        }
+
+    return done == count;
+    }
+
+// ---------------------------------------------------------------------------
+
+SkiWinFramePack::SkiWinFramePack()
+    {
+    mBase = NULL;
+    mLength = 0;
+    mHeader = NULL;
+    mEntries = NULL;
+    mFrameInterval = 0;
+    mStartTime = 0;
+    mNextFrame = 0;
+    mDropped = 0;
+    }
+
+SkiWinFramePack::~SkiWinFramePack()
+    {
+    close();
+    }
+
+/**
+ * open - Map a frame pack and validate its header and index.
+ */
+
+status_t SkiWinFramePack::open(const char* path)
+    {
+    struct stat st;
+
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return -errno;
+
+    // the header is read straight out of the mapping, it has to be there
+    if (fstat(fd, &st) < 0 || st.st_size < off_t(sizeof(SkiWinFramePackHeader)))
+        {
+        ::close(fd);
+        return BAD_VALUE;
+        }
+
+    void* base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    // the mapping keeps the file alive
+    ::close(fd);
+
+    if (base == MAP_FAILED)
+        return -errno;
+
+    mBase = static_cast<const uint8_t*>(base);
+    mLength = st.st_size;
+
+    const SkiWinFramePackHeader* header =
+        reinterpret_cast<const SkiWinFramePackHeader*>(mBase);
+    SkBitmap::Config config = SkBitmap::Config(header->config);
+    int bpp = bytesPerPixel(config);
+
+    // sizes are multiplied in 64 bits, a corrupt header must not wrap them
+    if (header->magic != SKIWIN_FRAMEPACK_MAGIC ||
+        header->version != SKIWIN_FRAMEPACK_VERSION ||
+        bpp == 0 || header->width == 0 || header->height == 0 ||
+        header->rowBytes != uint64_t(header->width) * bpp ||
+        header->frameCount == 0 || header->frameInterval == 0 ||
+        header->frameCount > (mLength - sizeof(*header)) /
+                             sizeof(SkiWinFramePackEntry))
+        {
+        ALOGE("'%s' is not a usable frame pack", path);
+        close();
+        return BAD_VALUE;
+        }
+
+    const SkiWinFramePackEntry* entries =
+        reinterpret_cast<const SkiWinFramePackEntry*>(header + 1);
+    uint64_t frameSize = uint64_t(header->rowBytes) * header->height;
+
+    for (uint32_t i = 0; i < header->frameCount; i++)
+        {
+        if (entries[i].offset > mLength ||
+            entries[i].size > mLength - entries[i].offset ||
+            (entries[i].encoding == SKIWIN_FRAMEPACK_RAW &&
+             entries[i].size != frameSize) ||
+            entries[i].encoding > SKIWIN_FRAMEPACK_RLE)
+            {
+            ALOGE("'%s' has a bad index entry %u", path, i);
+            close();
+            return BAD_VALUE;
+            }
+        }
+
+    mHeader = header;
+    mEntries = entries;
+    mFrameInterval = us2ns(header->frameInterval);
+
+    madvise((void*)mBase, mLength, MADV_SEQUENTIAL);
+
+    return NO_ERROR;
+    }
+
+void SkiWinFramePack::close()
+    {
+    if (mBase)
+        munmap((void*)mBase, mLength);
+
+    mBase = NULL;
+    mLength = 0;
+    mHeader = NULL;
+    mEntries = NULL;
+    mScratch.reset();
+    }
+
+/**
+ * getFrame - Point a bitmap at the pixels of a frame.
+ *
+ * Raw frames are not copied, the bitmap references the mapping and is only
+ * valid while the pack stays open. Encoded frames are expanded into a
+ * scratch bitmap that is reused by the next call.
+ */
+
+bool SkiWinFramePack::getFrame(int index, SkBitmap* bitmap)
+    {
+    if (mHeader == NULL || index < 0 || uint32_t(index) >= mHeader->frameCount)
+        return false;
+
+    const SkiWinFramePackEntry& entry = mEntries[index];
+    SkBitmap::Config config = SkBitmap::Config(mHeader->config);
+
+    if (entry.encoding == SKIWIN_FRAMEPACK_RAW)
+        {
+        bitmap->setConfig(config, mHeader->width, mHeader->height,
+                          mHeader->rowBytes);
+        bitmap->setPixels((void*)(mBase + entry.offset));
+        bitmap->setImmutable();
+        bitmap->setIsOpaque(true);
+        }
+    else
+        {
+        if (mScratch.isNull())
+            {
+            mScratch.setConfig(config, mHeader->width, mHeader->height,
+                               mHeader->rowBytes);
+            if (!mScratch.allocPixels())
+                return false;
+            mScratch.setIsOpaque(true);
+            }
+
+        if (!SkiWinFramePackDecodeRLE(mBase + entry.offset, entry.size,
+                                      bytesPerPixel(config),
+                                      mScratch.getPixels(),
+                                      mHeader->width * mHeader->height))
+            {
+            ALOGW("frame %d is corrupt", index);
+            return false;
+            }
+
+        mScratch.notifyPixelsChanged();
+        *bitmap = mScratch;
+        }
+
+    // get the next frame paged in while this one is shown
+    if (uint32_t(index) + 1 < mHeader->frameCount)
+        {
+        const SkiWinFramePackEntry& next = mEntries[index + 1];
+
+        madvise((void*)(mBase + next.offset), next.size, MADV_WILLNEED);
+        }
+
+    return true;
+    }
+
+void SkiWinFramePack::setFrameReadyCallback(FrameReadyCallback callback,
+                                            void* context)
+    {
+    // frames are always ready, nothing ever calls back
+    }
+
+status_t SkiWinFramePack::start()
+    {
+    mStartTime = 0;
+    mNextFrame = 0;
+    mDropped = 0;
+
+    return mHeader ? NO_ERROR : NO_INIT;
+    }
+
+void SkiWinFramePack::stop()
+    {
+    }
+
+nsecs_t SkiWinFramePack::getNextFrameTime()
+    {
+    if (mStartTime == 0)
+        return 0;
+
+    return mStartTime + nsecs_t(mNextFrame) * mFrameInterval;
+    }
+
+bool SkiWinFramePack::acquireFrame(nsecs_t now, SkBitmap* bitmap)
+    {
+    if (mHeader == NULL)
+        return false;
+
+    uint32_t due = 0;
+
+    if (mStartTime == 0)
+        mStartTime = now;
+    else
+        {
+        due = uint32_t((now - mStartTime) / mFrameInterval);
+
+        if (due < mNextFrame)
+            return false;
+        }
+
+    mDropped += due - mNextFrame;
+    mNextFrame = due + 1;
+
+    return getFrame(due % mHeader->frameCount, bitmap);
+    }
+
+uint32_t SkiWinFramePack::getDroppedFrames()
+    {
+    return mDropped;
+    }
+
+uint32_t SkiWinFramePack::getLoops()
+    {
+    return mHeader ? mNextFrame / mHeader->frameCount : 0;
+    }
+
+// ---------------------------------------------------------------------------
+
+SkiWinFramePackWriter::SkiWinFramePackWriter()
+    {
+    mFile = NULL;
+    mOffset = 0;
+    memset(&mHeader, 0, sizeof(mHeader));
+    }
+
+SkiWinFramePackWriter::~SkiWinFramePackWriter()
+    {
+    if (mFile)
+        fclose(mFile);
+    }
+
+status_t SkiWinFramePackWriter::write(const void* data, size_t size)
+    {
+    if (fwrite(data, 1, size, mFile) != size)
+        return -errno;
+
+    mOffset += size;
+    return NO_ERROR;
+    }
+
+status_t SkiWinFramePackWriter::pad()
+    {
+    static const uint8_t zeros[PAGE_SIZE] = { 0 };
+    size_t rem = mOffset % PAGE_SIZE;
+
+    if (rem == 0)
+        return NO_ERROR;
+
+    return write(zeros, PAGE_SIZE - rem);
+    }
+
+/**
+ * begin - Create the pack and reserve room for the header and index.
+ */
+
+status_t SkiWinFramePackWriter::begin(const char* path, int width, int height,
+                                      SkBitmap::Config config, int frameCount,
+                                      uint32_t frameInterval)
+    {
+    int bpp = bytesPerPixel(config);
+
+    if (bpp == 0 || width <= 0 || height <= 0 || frameCount <= 0)
+        return BAD_VALUE;
+
+    mFile = fopen(path, "wb");
+    if (mFile == NULL)
+        return -errno;
+
+    mPath = path;
+
+    mHeader.magic = SKIWIN_FRAMEPACK_MAGIC;
+    mHeader.version = SKIWIN_FRAMEPACK_VERSION;
+    mHeader.width = width;
+    mHeader.height = height;
+    mHeader.config = config;
+    mHeader.rowBytes = width * bpp;
+    mHeader.frameCount = frameCount;
+    mHeader.frameInterval = frameInterval;
+
+    SkiWinFramePackEntry entry;
+
+    memset(&entry, 0, sizeof(entry));
+    mEntries.clear();
+    mEntries.insertAt(entry, 0, frameCount);
+
+    mOffset = 0;
+
+    status_t err = write(&mHeader, sizeof(mHeader));
+    if (err == NO_ERROR)
+        err = write(mEntries.array(), frameCount * sizeof(entry));
+    if (err == NO_ERROR)
+        err = pad();
+
+    mHeader.frameCount = 0;
+
+    return err;
+    }
+
+/**
+ * addFrame - Append a frame, converted to the pack layout if needed.
+ *
+ * Run length encoding falls back to raw storage for frames it would make
+ * bigger.
+ */
+
+status_t SkiWinFramePackWriter::addFrame(const SkBitmap& bitmap,
+                                         uint32_t encoding)
+    {
+    SkBitmap::Config config = SkBitmap::Config(mHeader.config);
+    SkBitmap frame;
+
+    if (mFile == NULL || mHeader.frameCount >= mEntries.size())
+        return INVALID_OPERATION;
+
+    if (bitmap.width() != int(mHeader.width) ||
+        bitmap.height() != int(mHeader.height))
+        return BAD_VALUE;
+
+    // copyTo() also removes any row padding of the source
+    if (!bitmap.copyTo(&frame, config))
+        return NO_MEMORY;
+
+    SkAutoLockPixels alp(frame);
+
+    int bpp = bytesPerPixel(config);
+    size_t count = mHeader.width * mHeader.height;
+    size_t rawSize = count * bpp;
+    const void* data = frame.getPixels();
+    size_t size = rawSize;
+    uint8_t* rle = NULL;
+
+    if (frame.rowBytes() != mHeader.rowBytes)
+        return BAD_VALUE;
+
+    if (encoding == SKIWIN_FRAMEPACK_RLE)
+        {
+        rle = (uint8_t*)malloc(rawSize);
+        if (rle == NULL)
+            return NO_MEMORY;
+
+        size_t rleSize = SkiWinFramePackEncodeRLE(data, count, bpp, rle,
+                                                  rawSize - 1);
+
+        if (rleSize > 0)
+            {
+            data = rle;
+            size = rleSize;
+            }
+        else
+            encoding = SKIWIN_FRAMEPACK_RAW;
+        }
+
+    SkiWinFramePackEntry& entry = mEntries.editItemAt(mHeader.frameCount);
+
+    entry.offset = mOffset;
+    entry.size = size;
+    entry.encoding = encoding;
+
+    status_t err = write(data, size);
+    if (err == NO_ERROR)
+        err = pad();
+
+    free(rle);
+
+    if (err == NO_ERROR)
+        mHeader.frameCount++;
+
+    return err;
+    }
+
+/**
+ * finish - Write the final header and index, and close the pack.
+ */
+
+status_t SkiWinFramePackWriter::finish()
+    {
+    if (mFile == NULL)
+        return INVALID_OPERATION;
+
+    status_t err = NO_ERROR;
+
+    if (fseek(mFile, 0, SEEK_SET) != 0 ||
+        fwrite(&mHeader, sizeof(mHeader), 1, mFile) != 1 ||
+        fwrite(mEntries.array(), sizeof(SkiWinFramePackEntry),
+               mHeader.frameCount, mFile) != mHeader.frameCount)
+        err = -errno;
+
+    if (fclose(mFile) != 0 && err == NO_ERROR)
+        err = -errno;
+
+    mFile = NULL;
+
+    return err;
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_FRAME_PACK_H
+#define ANDROID_SKIWIN_FRAME_PACK_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+#include <SkBitmap.h>
+
+#include "SkiWinFrameSource.h"
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * Frame pack file layout, all fields little endian:
+ *
+ *   SkiWinFramePackHeader
+ *   SkiWinFramePackEntry[frameCount]
+ *   frame data, each frame starting on a page boundary
+ *
+ * Frames are stored in the pixel layout of the surface they are shown on
+ * (565 or 8888, rows packed without padding), either raw or run length
+ * encoded in units of whole pixels. A raw frame can be drawn straight out
+ * of the mapping.
+ *
+ * A run length encoded frame is a sequence of 16-bit tokens. A token with
+ * the top bit set is followed by one pixel repeated (token & 0x7fff) times,
+ * otherwise it is followed by that many literal pixels.
+ */
+
+#define SKIWIN_FRAMEPACK_MAGIC      0x4b505753  /* "SWPK" */
+#define SKIWIN_FRAMEPACK_VERSION    1
+
+enum
+    {
+    SKIWIN_FRAMEPACK_RAW = 0,
+    SKIWIN_FRAMEPACK_RLE = 1
+    };
+
+size_t SkiWinFramePackEncodeRLE(const void* pixels, size_t count, int bpp,
+                                uint8_t* out, size_t capacity);
+bool SkiWinFramePackDecodeRLE(const uint8_t* in, size_t size, int bpp,
+                              void* pixels, size_t count);
+
+struct SkiWinFramePackHeader
+    {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t config;        // SkBitmap::Config of every frame
+    uint32_t rowBytes;
+    uint32_t frameCount;
+    uint32_t frameInterval; // microseconds
+    };
+
+struct SkiWinFramePackEntry
+    {
+    uint64_t offset;
+    uint32_t size;
+    uint32_t encoding;
+    };
+
+/*
+ * SkiWinFramePack - Memory mapped frame pack played back as a frame source.
+ *
+ * No thread is involved: picking a raw frame only points a bitmap at the
+ * mapping, a run length encoded one is expanded into a scratch bitmap.
+ */
+
+class SkiWinFramePack : public SkiWinFrameSource
+    {
+    public:
+        SkiWinFramePack();
+        virtual ~SkiWinFramePack();
+
+        status_t open(const char* path);
+        void close();
+
+        int getFrameCount() const
+            {
+            return mHeader ? mHeader->frameCount : 0;
+            }
+        bool getFrame(int index, SkBitmap* bitmap);
+
+        virtual void setFrameReadyCallback(FrameReadyCallback callback,
+                                           void* context);
+
+        virtual status_t start();
+        virtual void stop();
+
+        virtual nsecs_t getNextFrameTime();
+        virtual bool acquireFrame(nsecs_t now, SkBitmap* bitmap);
+
+        virtual uint32_t getDroppedFrames();
+        virtual uint32_t getLoops();
+
+    private:
+        const uint8_t* mBase;
+        size_t mLength;
+
+        const SkiWinFramePackHeader* mHeader;
+        const SkiWinFramePackEntry* mEntries;
+
+        SkBitmap mScratch;
+
+        nsecs_t mFrameInterval;
+        nsecs_t mStartTime;
+        uint32_t mNextFrame;     // counts across loops
+        uint32_t mDropped;
+    };
+
+/*
+ * SkiWinFramePackWriter - Builds a frame pack, used by the converter tool.
+ */
+
+class SkiWinFramePackWriter
+    {
+    public:
+        SkiWinFramePackWriter();
+        ~SkiWinFramePackWriter();
+
+        status_t begin(const char* path, int width, int height,
+                       SkBitmap::Config config, int frameCount,
+                       uint32_t frameInterval);
+        status_t addFrame(const SkBitmap& bitmap, uint32_t encoding);
+        status_t finish();
+
+    private:
+        status_t write(const void* data, size_t size);
+        status_t pad();
+
+        FILE* mFile;
+        String8 mPath;
+        SkiWinFramePackHeader mHeader;
+        Vector<SkiWinFramePackEntry> mEntries;
+        uint64_t mOffset;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_FRAME_PACK_H
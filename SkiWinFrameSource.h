@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_FRAME_SOURCE_H
+#define ANDROID_SKIWIN_FRAME_SOURCE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/RefBase.h>
+#include <utils/Timers.h>
+
+#include <SkBitmap.h>
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+typedef void (*FrameReadyCallback)(void* context);
+
+/*
+ * SkiWinFrameSource - A timed sequence of frames the compositor picks from.
+ *
+ * The compositor asks for the presentation time of the next frame to know
+ * when to wake up, then takes the frame that is due with acquireFrame().
+ */
+
+class SkiWinFrameSource : public RefBase
+    {
+    public:
+        virtual ~SkiWinFrameSource() {}
+
+        virtual void setFrameReadyCallback(FrameReadyCallback callback,
+                                           void* context) = 0;
+
+        virtual status_t start() = 0;
+        virtual void stop() = 0;
+
+        virtual nsecs_t getNextFrameTime() = 0;
+        virtual bool acquireFrame(nsecs_t now, SkBitmap* bitmap) = 0;
+
+        virtual uint32_t getDroppedFrames() = 0;
+        virtual uint32_t getLoops() = 0;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_FRAME_SOURCE_H
@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinFrameStats"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <cutils/sockets.h>
+#include <utils/Log.h>
+
+#include "SkiWinFrameStats.h"
+
+#define STATS_SOCKET_NAME "skiwin-stats"
+
+namespace android
+{
+
+static const char* gMetricNames[STATS_METRIC_COUNT] =
+    {
+    "lock",
+    "draw",
+    "post",
+    "bytes",
+    "frame",
+    "queued",
+    "handled",
+    "shown"
+    };
+
+SkiWinFrameStats* SkiWinFrameStats::get()
+    {
+    static SkiWinFrameStats sStats;
+
+    return &sStats;
+    }
+
+SkiWinFrameStats::SkiWinFrameStats()
+    {
+    pthread_key_create(&mThreadKey, NULL);
+
+    mThreads = NULL;
+    mRowCount = 0;
+    mServerFd = -1;
+
+    mDumpFd = eventfd(0, EFD_NONBLOCK);
+
+    ALOGE_IF(mDumpFd < 0, "eventfd failed (%s)", strerror(errno));
+
+    addRow("frame");
+    addRow("input");
+    }
+
+/*
+ * The statistics live as long as the process, the per-thread histograms
+ * are never freed since the threads recording into them never exit
+ * before it does.
+ */
+
+SkiWinFrameStats::~SkiWinFrameStats()
+    {
+    }
+
+/**
+ * bucketFor - Histogram bucket of a value.
+ *
+ * Values below 8 get a bucket each, above that every power of two is split
+ * into 8 buckets. Values too large for the last bucket are counted in it.
+ */
+
+int SkiWinFrameStats::bucketFor(uint64_t value)
+    {
+    if (value < 8)
+        return int(value);
+
+    int msb = 63 - __builtin_clzll(value);
+    int bucket = (msb - 2) * 8 + int((value >> (msb - 3)) & 7);
+
+    return bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1;
+    }
+
+/* Largest value counted in a bucket. */
+
+uint64_t SkiWinFrameStats::bucketLimit(int bucket)
+    {
+    if (bucket < 16)
+        return bucket;
+
+    int shift = bucket / 8 - 1;
+
+    return ((uint64_t(8 + bucket % 8) + 1) << shift) - 1;
+    }
+
+/**
+ * addRow - Get the row of a view, by name.
+ *
+ * A window opened again under the same name adds to the row it had before,
+ * so windows coming and going do not run out of rows.
+ */
+
+int SkiWinFrameStats::addRow(const char* name)
+    {
+    Mutex::Autolock _l(mLock);
+
+    for (int i = 0; i < mRowCount; i++)
+        {
+        if (strncmp(mRowNames[i], name, MAX_NAME - 1) == 0)
+            return i;
+        }
+
+    if (mRowCount >= MAX_ROWS)
+        {
+        ALOGW("no stats row left for %s", name);
+        return -1;
+        }
+
+    strlcpy(mRowNames[mRowCount], name, MAX_NAME);
+
+    return mRowCount++;
+    }
+
+SkiWinFrameStats::ThreadStats* SkiWinFrameStats::getThreadStats()
+    {
+    ThreadStats* stats = (ThreadStats*)pthread_getspecific(mThreadKey);
+
+    if (stats == NULL)
+        {
+        stats = (ThreadStats*)calloc(1, sizeof(ThreadStats));
+        if (stats == NULL)
+            return NULL;
+
+        Mutex::Autolock _l(mLock);
+
+        stats->next = mThreads;
+        mThreads = stats;
+
+        pthread_setspecific(mThreadKey, stats);
+        }
+
+    return stats;
+    }
+
+/**
+ * record - Count a value, from any thread.
+ *
+ * Only the calling thread writes its histograms, a dump running at the
+ * same time may miss the value but never sees a corrupted one.
+ */
+
+void SkiWinFrameStats::record(int row, int metric, uint64_t value)
+    {
+    if (row < 0 || row >= MAX_ROWS || metric < 0 ||
+        metric >= STATS_METRIC_COUNT)
+        return;
+
+    ThreadStats* stats = getThreadStats();
+    if (stats == NULL)
+        return;
+
+    Histogram& histogram = stats->histograms[row][metric];
+
+    histogram.buckets[bucketFor(value)]++;
+    histogram.count++;
+
+    if (value > histogram.max)
+        histogram.max = value;
+    }
+
+/**
+ * format - The merged histograms as a table, one line per row and metric.
+ *
+ * Percentiles are the upper limit of the bucket they fall in. Times are
+ * in microseconds.
+ */
+
+String8 SkiWinFrameStats::format()
+    {
+    static const int percents[] = { 50, 90, 99 };
+
+    Mutex::Autolock _l(mLock);
+
+    String8 out("row metric count p50 p90 p99 max\n");
+
+    for (int row = 0; row < mRowCount; row++)
+        {
+        for (int metric = 0; metric < STATS_METRIC_COUNT; metric++)
+            {
+            Histogram merged;
+
+            memset(&merged, 0, sizeof(merged));
+
+            for (ThreadStats* t = mThreads; t != NULL; t = t->next)
+                {
+                const Histogram& h = t->histograms[row][metric];
+
+                for (int i = 0; i < BUCKET_COUNT; i++)
+                    merged.buckets[i] += h.buckets[i];
+
+                merged.count += h.count;
+
+                if (h.max > merged.max)
+                    merged.max = h.max;
+                }
+
+            if (merged.count == 0)
+                continue;
+
+            out.appendFormat("%s %s %u", mRowNames[row],
+                             gMetricNames[metric], merged.count);
+
+            for (size_t p = 0; p < sizeof(percents) / sizeof(percents[0]); p++)
+                {
+                uint64_t rank = (uint64_t(merged.count) * percents[p] + 99) / 100;
+                uint64_t seen = 0;
+                int bucket = 0;
+
+                for (; bucket < BUCKET_COUNT - 1; bucket++)
+                    {
+                    seen += merged.buckets[bucket];
+                    if (seen >= rank)
+                        break;
+                    }
+
+                uint64_t value = bucketLimit(bucket);
+
+                if (value > merged.max)
+                    value = merged.max;
+
+                out.appendFormat(" %llu", (unsigned long long)value);
+                }
+
+            out.appendFormat(" %llu\n", (unsigned long long)merged.max);
+            }
+        }
+
+    return out;
+    }
+
+/**
+ * startDumpServer - Start serving dumps on the local socket and SIGUSR1.
+ */
+
+status_t SkiWinFrameStats::startDumpServer()
+    {
+    if (mDumpThread != NULL)
+        return NO_ERROR;
+
+    mServerFd = socket_local_server(STATS_SOCKET_NAME,
+                                    ANDROID_SOCKET_NAMESPACE_ABSTRACT,
+                                    SOCK_STREAM);
+
+    ALOGW_IF(mServerFd < 0, "cannot listen on @%s (%s), dumps go to the log only",
+             STATS_SOCKET_NAME, strerror(errno));
+
+    mDumpThread = new DumpThread(this);
+
+    return mDumpThread->run("SkiWinFrameStats", PRIORITY_BACKGROUND);
+    }
+
+/**
+ * requestDump - Dump the table to the log from the dump thread.
+ *
+ * Only writes to an eventfd, so it can be called from a signal handler.
+ */
+
+void SkiWinFrameStats::requestDump()
+    {
+    uint64_t inc = 1;
+
+    write(mDumpFd, &inc, sizeof(inc));
+    }
+
+bool SkiWinFrameStats::serveDump()
+    {
+    struct pollfd pfd[2];
+    int count = 0;
+
+    pfd[count].fd = mDumpFd;
+    pfd[count].events = POLLIN;
+    pfd[count].revents = 0;
+    count++;
+
+    if (mServerFd >= 0)
+        {
+        pfd[count].fd = mServerFd;
+        pfd[count].events = POLLIN;
+        pfd[count].revents = 0;
+        count++;
+        }
+
+    if (poll(pfd, count, -1) < 0)
+        return errno == EINTR;
+
+    if (pfd[0].revents & POLLIN)
+        {
+        uint64_t counter;
+
+        read(mDumpFd, &counter, sizeof(counter));
+
+        String8 table = format();
+        const char* line = table.string();
+
+        while (*line)
+            {
+            const char* eol = strchr(line, '\n');
+            int len = eol ? eol - line : strlen(line);
+
+            ALOGI("%.*s", len, line);
+
+            line += eol ? len + 1 : len;
+            }
+        }
+
+    if (count > 1 && (pfd[1].revents & POLLIN))
+        {
+        int fd = accept(mServerFd, NULL, NULL);
+
+        if (fd >= 0)
+            {
+            String8 table = format();
+
+            write(fd, table.string(), table.length());
+            close(fd);
+            }
+        }
+
+    return true;
+    }
+
+bool SkiWinFrameStats::DumpThread::threadLoop()
+    {
+    return mStats->serveDump();
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
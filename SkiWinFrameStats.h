@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_FRAME_STATS_H
+#define ANDROID_SKIWIN_FRAME_STATS_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <pthread.h>
+
+#include <utils/Errors.h>
+#include <utils/String8.h>
+#include <utils/threads.h>
+#include <utils/Timers.h>
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+enum
+    {
+    STATS_LOCK,     // us waiting in lockCanvas() for a buffer
+    STATS_DRAW,     // us drawing a view
+    STATS_POST,     // us in unlockCanvasAndPost()
+    STATS_BYTES,    // bytes of the buffer redrawn
+    STATS_FRAME,    // us from the first lock to the last post of a frame
+    STATS_INPUT_QUEUED,     // us from an input event until SkiWin took it
+    STATS_INPUT_HANDLED,    // us from an input event until a window handled it
+    STATS_INPUT_SHOWN,      // us from an input event until a frame after it was posted
+    STATS_METRIC_COUNT
+    };
+
+// row of the numbers that are per frame rather than per view
+#define STATS_ROW_FRAME 0
+
+// row of the input latencies, measured from the time the kernel gave
+#define STATS_ROW_INPUT 1
+
+/*
+ * SkiWinFrameStats - Histograms of the per-view and per-frame costs.
+ *
+ * Every thread records into histograms of its own, so record() takes no
+ * lock and has no shared cache lines. Buckets are log-linear, 8 per power
+ * of two, so percentiles are within 12.5%, max is exact.
+ *
+ * The table of count/p50/p90/p99/max per row and metric is dumped to the
+ * log on SIGUSR1, and to anyone connecting to the abstract local socket
+ * "skiwin-stats".
+ */
+
+class SkiWinFrameStats
+    {
+    public:
+        static SkiWinFrameStats* get();
+
+        int addRow(const char* name);
+
+        void record(int row, int metric, uint64_t value);
+        void recordTime(int row, int metric, nsecs_t start)
+            {
+            record(row, metric, ns2us(systemTime() - start));
+            }
+
+        String8 format();
+
+        status_t startDumpServer();
+        void requestDump();
+
+    private:
+        enum
+            {
+            MAX_ROWS = 16,
+            MAX_NAME = 32,
+            BUCKET_COUNT = 320
+            };
+
+        struct Histogram
+            {
+            uint32_t buckets[BUCKET_COUNT];
+            uint32_t count;
+            uint64_t max;
+            };
+
+        struct ThreadStats
+            {
+            ThreadStats* next;
+            Histogram histograms[MAX_ROWS][STATS_METRIC_COUNT];
+            };
+
+        class DumpThread : public Thread
+            {
+            public:
+                DumpThread(SkiWinFrameStats* stats) : mStats(stats) {}
+            private:
+                virtual bool threadLoop();
+                SkiWinFrameStats* mStats;
+            };
+
+        SkiWinFrameStats();
+        ~SkiWinFrameStats();
+
+        static int bucketFor(uint64_t value);
+        static uint64_t bucketLimit(int bucket);
+
+        ThreadStats* getThreadStats();
+        bool serveDump();
+
+        pthread_key_t mThreadKey;
+
+        // threads are only ever added, at the front
+        Mutex mLock;
+        ThreadStats* mThreads;
+
+        char mRowNames[MAX_ROWS][MAX_NAME];
+        int mRowCount;
+
+        int mDumpFd;
+        int mServerFd;
+        sp<DumpThread> mDumpThread;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_FRAME_STATS_H
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_HASH_H
+#define ANDROID_SKIWIN_HASH_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/* 64-bit FNV-1a, used to key caches on the content of a buffer. */
+
+static inline uint64_t SkiWinHash64(const void* buffer, size_t size)
+    {
+    const uint8_t* p = static_cast<const uint8_t*>(buffer);
+    uint64_t hash = 14695981039346656037ULL;
+
+    while (size--)
+        {
+        hash ^= *p++;
+        hash *= 1099511628211ULL;
+        }
+
+    return hash;
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_HASH_H
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinImageCache"
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include <core/SkBitmap.h>
+#include <images/SkImageDecoder.h>
+
+#include "SkiWinHash.h"
+#include "SkiWinImageCache.h"
+
+namespace android
+{
+
+bool SkiWinImageCache::Key::operator<(const Key& rhs) const
+    {
+    if (hash != rhs.hash)
+        return hash < rhs.hash;
+    if (size != rhs.size)
+        return size < rhs.size;
+    return config < rhs.config;
+    }
+
+SkiWinImageCache::SkiWinImageCache(size_t budget)
+    {
+    mHead = NULL;
+    mTail = NULL;
+    mBudget = budget;
+    mUsed = 0;
+    mHits = 0;
+    mMisses = 0;
+    mEvictions = 0;
+    }
+
+SkiWinImageCache::~SkiWinImageCache()
+    {
+    purge();
+    }
+
+void SkiWinImageCache::unlink(Entry* entry)
+    {
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        mHead = entry->next;
+
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        mTail = entry->prev;
+
+    entry->prev = NULL;
+    entry->next = NULL;
+    }
+
+void SkiWinImageCache::pushFront(Entry* entry)
+    {
+    entry->prev = NULL;
+    entry->next = mHead;
+
+    if (mHead)
+        mHead->prev = entry;
+    else
+        mTail = entry;
+
+    mHead = entry;
+    }
+
+/* Evict from the cold end until the cache fits in the given budget. */
+
+void SkiWinImageCache::trim(size_t budget)
+    {
+    while (mTail && mUsed > budget)
+        {
+        Entry* victim = mTail;
+
+        unlink(victim);
+        mEntries.removeItem(victim->key);
+        mUsed -= victim->bytes;
+        mEvictions++;
+
+        delete victim;
+        }
+    }
+
+/**
+ * decode - Decode an encoded image buffer, reusing a previous decode.
+ *
+ * On a hit the returned bitmap shares its pixels with the cached one. A
+ * decoded bitmap larger than the whole budget is returned but not kept.
+ */
+
+bool SkiWinImageCache::decode(const void* buffer, size_t size,
+                              SkBitmap* bitmap, SkBitmap::Config config)
+    {
+    Key key;
+
+    key.hash = SkiWinHash64(buffer, size);
+    key.size = size;
+    key.config = config;
+
+        {
+        Mutex::Autolock _l(mLock);
+
+        ssize_t index = mEntries.indexOfKey(key);
+
+        if (index >= 0)
+            {
+            Entry* entry = mEntries.valueAt(index);
+
+            unlink(entry);
+            pushFront(entry);
+            mHits++;
+
+            *bitmap = entry->bitmap;
+            return true;
+            }
+
+        mMisses++;
+        }
+
+    // decode without holding the lock, it is by far the slowest part
+    SkBitmap decoded;
+
+    if (!SkImageDecoder::DecodeMemory(buffer, size, &decoded, config,
+                                      SkImageDecoder::kDecodePixels_Mode) ||
+        !decoded.pixelRef())
+        {
+        return false;
+        }
+
+    *bitmap = decoded;
+
+    Mutex::Autolock _l(mLock);
+
+    size_t bytes = decoded.getSize();
+
+    if (bytes > mBudget || mEntries.indexOfKey(key) >= 0)
+        return true;
+
+    trim(mBudget - bytes);
+
+    Entry* entry = new Entry;
+    entry->key = key;
+    entry->bitmap = decoded;
+    entry->bytes = bytes;
+
+    pushFront(entry);
+    mEntries.add(key, entry);
+    mUsed += bytes;
+
+    return true;
+    }
+
+void SkiWinImageCache::setBudget(size_t budget)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mBudget = budget;
+    trim(mBudget);
+    }
+
+size_t SkiWinImageCache::getBudget()
+    {
+    Mutex::Autolock _l(mLock);
+
+    return mBudget;
+    }
+
+size_t SkiWinImageCache::getUsed()
+    {
+    Mutex::Autolock _l(mLock);
+
+    return mUsed;
+    }
+
+void SkiWinImageCache::purge()
+    {
+    Mutex::Autolock _l(mLock);
+
+    trim(0);
+    }
+
+void SkiWinImageCache::dump()
+    {
+    Mutex::Autolock _l(mLock);
+
+    ALOGD("image cache: %d entries, %d/%d bytes, hits %u misses %u evictions %u",
+          mEntries.size(), mUsed, mBudget, mHits, mMisses, mEvictions);
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
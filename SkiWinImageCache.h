@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_IMAGE_CACHE_H
+#define ANDROID_SKIWIN_IMAGE_CACHE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/threads.h>
+#include <utils/KeyedVector.h>
+
+#include <SkBitmap.h>
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * SkiWinImageCache - Decoded bitmaps keyed on the content of the encoded
+ * buffer and the requested config.
+ *
+ * Entries are evicted least recently used first once the decoded pixels
+ * exceed the byte budget. Bitmaps handed out share their pixels with the
+ * cache, so an evicted entry stays valid for whoever still holds it.
+ */
+
+class SkiWinImageCache
+    {
+    public:
+        SkiWinImageCache(size_t budget);
+        ~SkiWinImageCache();
+
+        bool decode(const void* buffer, size_t size, SkBitmap* bitmap,
+                    SkBitmap::Config config = SkBitmap::kNo_Config);
+
+        void setBudget(size_t budget);
+        size_t getBudget();
+        size_t getUsed();
+
+        void purge();
+        void dump();
+
+        uint32_t getHits()
+            {
+            return mHits;
+            }
+        uint32_t getMisses()
+            {
+            return mMisses;
+            }
+
+    private:
+        struct Key
+            {
+            uint64_t hash;
+            size_t size;
+            SkBitmap::Config config;
+
+            bool operator<(const Key& rhs) const;
+            };
+
+        struct Entry
+            {
+            Key key;
+            SkBitmap bitmap;
+            size_t bytes;
+            Entry* prev;
+            Entry* next;
+            };
+
+        void unlink(Entry* entry);
+        void pushFront(Entry* entry);
+        void trim(size_t budget);
+
+        Mutex mLock;
+
+        KeyedVector<Key, Entry*> mEntries;
+
+        // most recently used first
+        Entry* mHead;
+        Entry* mTail;
+
+        size_t mBudget;
+        size_t mUsed;
+
+        uint32_t mHits;
+        uint32_t mMisses;
+        uint32_t mEvictions;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_IMAGE_CACHE_H
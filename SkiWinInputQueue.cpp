@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define LOG_TAG "SkiWinInputQueue"
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Atomic.h>
+#include <utils/Log.h>
+
+#include "SkiWinInputQueue.h"
+
+namespace android
+{
+
+/**
+ * SkiWinInputQueue - Make room for capacity events, rounded up to a power
+ * of two.
+ */
+
+SkiWinInputQueue::SkiWinInputQueue(size_t capacity)
+    {
+    size_t size = 1;
+
+    while (size < capacity)
+        size <<= 1;
+
+    mEvents = new SkiWinInputEvent[size];
+    mMask = size - 1;
+    mHead = 0;
+    mTail = 0;
+    mDropped = 0;
+    }
+
+SkiWinInputQueue::~SkiWinInputQueue()
+    {
+    delete[] mEvents;
+    }
+
+/**
+ * push - Append an event, only ever called by the producer.
+ *
+ * Returns false, dropping the event, when the consumer has fallen a whole
+ * ring behind.
+ */
+
+bool SkiWinInputQueue::push(const SkiWinInputEvent& event)
+    {
+    uint32_t tail = uint32_t(mTail);
+    uint32_t head = uint32_t(android_atomic_acquire_load(&mHead));
+
+    if (tail - head > mMask)
+        {
+        android_atomic_inc(&mDropped);
+        return false;
+        }
+
+    mEvents[tail & mMask] = event;
+
+    android_atomic_release_store(int32_t(tail + 1), &mTail);
+
+    return true;
+    }
+
+/**
+ * isFull - Whether a push would fail now, only ever called by the producer.
+ *
+ * The consumer can only make room, so a false answer holds until the
+ * next push.
+ */
+
+bool SkiWinInputQueue::isFull()
+    {
+    uint32_t tail = uint32_t(mTail);
+    uint32_t head = uint32_t(android_atomic_acquire_load(&mHead));
+
+    return tail - head > mMask;
+    }
+
+/**
+ * pop - Take the oldest event, only ever called by the consumer.
+ *
+ * Returns false if there is none.
+ */
+
+bool SkiWinInputQueue::pop(SkiWinInputEvent* event)
+    {
+    uint32_t head = uint32_t(mHead);
+    uint32_t tail = uint32_t(android_atomic_acquire_load(&mTail));
+
+    if (head == tail)
+        return false;
+
+    *event = mEvents[head & mMask];
+
+    android_atomic_release_store(int32_t(head + 1), &mHead);
+
+    return true;
+    }
+
+uint32_t SkiWinInputQueue::getDropped()
+    {
+    return uint32_t(android_atomic_acquire_load(&mDropped));
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_SKIWIN_INPUT_QUEUE_H
+#define ANDROID_SKIWIN_INPUT_QUEUE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Timers.h>
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * A key or touch as the input reader reported it, screen coordinates. x
+ * and y are the first pointer, a touch has all of them in pointerIds,
+ * pointerX and pointerY, the action keeps the pointer index of a
+ * POINTER_DOWN or POINTER_UP.
+ */
+
+struct SkiWinInputEvent
+    {
+    enum
+        {
+        TYPE_KEY,
+        TYPE_MOTION
+        };
+
+    enum
+        {
+        MAX_POINTERS = 4
+        };
+
+    int32_t type;
+    int32_t action;
+    int32_t keyCode;
+    int32_t x;
+    int32_t y;
+    nsecs_t eventTime;
+
+    int32_t pointerCount;
+    int32_t pointerIds[MAX_POINTERS];
+    int32_t pointerX[MAX_POINTERS];
+    int32_t pointerY[MAX_POINTERS];
+    };
+
+/* A position the first pointer went through, older than the one dispatched. */
+
+struct SkiWinMotionSample
+    {
+    int32_t x;
+    int32_t y;
+    nsecs_t eventTime;
+    };
+
+/*
+ * SkiWinInputQueue - Bounded ring of input events from the input reader
+ * thread to the SkiWin thread.
+ *
+ * There is exactly one producer and one consumer, each owning one end of
+ * the ring, so neither takes a lock: the producer publishes an event by
+ * a release store of the tail after writing it, the consumer frees its
+ * slot by a release store of the head after reading it. Events that find
+ * the ring full are dropped and counted.
+ */
+
+class SkiWinInputQueue
+    {
+    public:
+        SkiWinInputQueue(size_t capacity);
+        ~SkiWinInputQueue();
+
+        // producer side
+        bool push(const SkiWinInputEvent& event);
+        bool isFull();
+
+        // consumer side
+        bool pop(SkiWinInputEvent* event);
+
+        uint32_t getDropped();
+
+    private:
+        SkiWinInputEvent* mEvents;
+        uint32_t mMask;
+
+        // free running, the slot of either is its value & mMask
+        volatile int32_t mHead;
+        volatile int32_t mTail;
+
+        volatile int32_t mDropped;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_INPUT_QUEUE_H
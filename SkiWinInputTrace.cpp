@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define LOG_TAG "SkiWinInputTrace"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <utils/Log.h>
+
+#include "SkiWinInputTrace.h"
+
+// longest sleep between checks for the player being stopped
+#define MAX_REPLAY_SLEEP ms2ns(100)
+
+// how often a player held back by a full input queue looks again
+#define QUEUE_FULL_POLL ms2ns(1)
+
+namespace android
+{
+
+SkiWinInputRecorder::SkiWinInputRecorder()
+    {
+    mFile = NULL;
+    mRecords = 0;
+    }
+
+SkiWinInputRecorder::~SkiWinInputRecorder()
+    {
+    close();
+    }
+
+/**
+ * open - Start a new trace at path, replacing what was there.
+ */
+
+status_t SkiWinInputRecorder::open(const char* path)
+    {
+    SkiWinInputTraceHeader header;
+
+    close();
+
+    mFile = fopen(path, "wb");
+    if (mFile == NULL)
+        return -errno;
+
+    header.magic = SKIWIN_INPUTTRACE_MAGIC;
+    header.version = SKIWIN_INPUTTRACE_VERSION;
+
+    write(&header, sizeof(header));
+    flush();
+
+    return mFile != NULL ? NO_ERROR : UNKNOWN_ERROR;
+    }
+
+void SkiWinInputRecorder::close()
+    {
+    if (mFile == NULL)
+        return;
+
+    ALOGI("recorded %u events", mRecords);
+
+    fclose(mFile);
+    mFile = NULL;
+    mRecords = 0;
+    }
+
+/**
+ * write - Append to the trace, stopping the recording if that fails.
+ */
+
+void SkiWinInputRecorder::write(const void* data, size_t size)
+    {
+    if (mFile == NULL)
+        return;
+
+    if (fwrite(data, 1, size, mFile) != size)
+        {
+        ALOGE("input trace write failed (%s), recording stopped",
+              strerror(errno));
+        close();
+        }
+    }
+
+void SkiWinInputRecorder::flush()
+    {
+    if (mFile != NULL && fflush(mFile) != 0)
+        {
+        ALOGE("input trace flush failed (%s), recording stopped",
+              strerror(errno));
+        close();
+        }
+    }
+
+void SkiWinInputRecorder::recordKey(const NotifyKeyArgs* args)
+    {
+    SkiWinInputTraceRecord record;
+
+    if (mFile == NULL)
+        return;
+
+    memset(&record, 0, sizeof(record));
+
+    record.type = SKIWIN_INPUTTRACE_KEY;
+    record.eventTime = args->eventTime;
+    record.downTime = args->downTime;
+    record.deviceId = args->deviceId;
+    record.source = args->source;
+    record.policyFlags = args->policyFlags;
+    record.action = args->action;
+    record.flags = args->flags;
+    record.metaState = args->metaState;
+    record.keyCode = args->keyCode;
+    record.scanCode = args->scanCode;
+
+    write(&record, sizeof(record));
+    flush();
+    mRecords++;
+    }
+
+void SkiWinInputRecorder::recordMotion(const NotifyMotionArgs* args)
+    {
+    SkiWinInputTraceRecord record;
+
+    if (mFile == NULL)
+        return;
+
+    memset(&record, 0, sizeof(record));
+
+    record.type = SKIWIN_INPUTTRACE_MOTION;
+    record.pointerCount = args->pointerCount;
+    record.eventTime = args->eventTime;
+    record.downTime = args->downTime;
+    record.deviceId = args->deviceId;
+    record.source = args->source;
+    record.policyFlags = args->policyFlags;
+    record.action = args->action;
+    record.flags = args->flags;
+    record.metaState = args->metaState;
+    record.buttonState = args->buttonState;
+    record.edgeFlags = args->edgeFlags;
+    record.displayId = args->displayId;
+    record.xPrecision = args->xPrecision;
+    record.yPrecision = args->yPrecision;
+
+    write(&record, sizeof(record));
+
+    for (uint32_t i = 0; i < args->pointerCount; i++)
+        {
+        const PointerCoords& coords = args->pointerCoords[i];
+        SkiWinInputTracePointer pointer;
+
+        pointer.id = args->pointerProperties[i].id;
+        pointer.toolType = args->pointerProperties[i].toolType;
+        pointer.x = coords.getAxisValue(AMOTION_EVENT_AXIS_X);
+        pointer.y = coords.getAxisValue(AMOTION_EVENT_AXIS_Y);
+        pointer.pressure = coords.getAxisValue(AMOTION_EVENT_AXIS_PRESSURE);
+
+        write(&pointer, sizeof(pointer));
+        }
+
+    flush();
+    mRecords++;
+    }
+
+// ---------------------------------------------------------------------------
+
+SkiWinInputPlayer::SkiWinInputPlayer(const sp<InputListenerInterface>& listener,
+                                     SkiWinEventCallback* callback, bool fast)
+    : Thread(false),
+      mListener(listener),
+      mCallback(callback),
+      mFast(fast)
+    {
+    mFile = NULL;
+    mRecords = 0;
+    mTraceStart = 0;
+    mStartTime = 0;
+    }
+
+SkiWinInputPlayer::~SkiWinInputPlayer()
+    {
+    if (mFile != NULL)
+        fclose(mFile);
+    }
+
+/**
+ * open - Open the trace at path, the events start when the thread runs.
+ */
+
+status_t SkiWinInputPlayer::open(const char* path)
+    {
+    SkiWinInputTraceHeader header;
+
+    mFile = fopen(path, "rb");
+    if (mFile == NULL)
+        return -errno;
+
+    if (!read(&header, sizeof(header)) ||
+        header.magic != SKIWIN_INPUTTRACE_MAGIC ||
+        header.version != SKIWIN_INPUTTRACE_VERSION)
+        {
+        fclose(mFile);
+        mFile = NULL;
+        return BAD_VALUE;
+        }
+
+    return NO_ERROR;
+    }
+
+bool SkiWinInputPlayer::read(void* data, size_t size)
+    {
+    return size == 0 || fread(data, 1, size, mFile) == size;
+    }
+
+/**
+ * sleepUntil - Wait for when, returns false if the player is stopped first.
+ */
+
+bool SkiWinInputPlayer::sleepUntil(nsecs_t when)
+    {
+    for (;;)
+        {
+        nsecs_t delay = when - systemTime();
+
+        if (exitPending())
+            return false;
+
+        if (delay <= 0)
+            return true;
+
+        if (delay > MAX_REPLAY_SLEEP)
+            delay = MAX_REPLAY_SLEEP;
+
+        usleep(ns2us(delay));
+        }
+    }
+
+/**
+ * waitForRoom - Wait until SkiWin can take another event, returns false
+ * if the player is stopped first.
+ */
+
+bool SkiWinInputPlayer::waitForRoom()
+    {
+    while (mCallback->pfInputQueueFull(mCallback->context))
+        {
+        if (exitPending())
+            return false;
+
+        usleep(ns2us(QUEUE_FULL_POLL));
+        }
+
+    return true;
+    }
+
+/**
+ * threadLoop - Replay one event, the thread ends with the trace.
+ */
+
+bool SkiWinInputPlayer::threadLoop()
+    {
+    SkiWinInputTraceRecord record;
+    SkiWinInputTracePointer pointers[MAX_POINTERS];
+    PointerProperties properties[MAX_POINTERS];
+    PointerCoords coords[MAX_POINTERS];
+    nsecs_t when;
+
+    if (mFile == NULL)
+        return false;
+
+    if (!read(&record, sizeof(record)))
+        {
+        ALOGI("replayed %u events in %lld ms", mRecords,
+              mRecords ? (long long)ns2ms(systemTime() - mStartTime) : 0LL);
+        return false;
+        }
+
+    if (record.pointerCount > MAX_POINTERS ||
+        !read(pointers, record.pointerCount * sizeof(pointers[0])))
+        {
+        ALOGE("input trace corrupt after %u events", mRecords);
+        return false;
+        }
+
+    if (mRecords == 0)
+        {
+        mTraceStart = record.eventTime;
+        mStartTime = systemTime();
+        }
+
+    if (!mFast)
+        {
+        when = mStartTime + (record.eventTime - mTraceStart);
+
+        if (!sleepUntil(when))
+            return false;
+        }
+
+    if (!waitForRoom())
+        return false;
+
+    if (mFast)
+        when = systemTime();
+
+    // the event happens now, its gesture started as long ago as it did
+    nsecs_t shift = when - record.eventTime;
+
+    if (record.type == SKIWIN_INPUTTRACE_KEY)
+        {
+        NotifyKeyArgs args(when, record.deviceId, record.source,
+                           record.policyFlags, record.action, record.flags,
+                           record.keyCode, record.scanCode, record.metaState,
+                           record.downTime + shift);
+
+        mListener->notifyKey(&args);
+        }
+    else
+        {
+        for (uint32_t i = 0; i < record.pointerCount; i++)
+            {
+            properties[i].clear();
+            properties[i].id = pointers[i].id;
+            properties[i].toolType = pointers[i].toolType;
+
+            coords[i].clear();
+            coords[i].setAxisValue(AMOTION_EVENT_AXIS_X, pointers[i].x);
+            coords[i].setAxisValue(AMOTION_EVENT_AXIS_Y, pointers[i].y);
+            coords[i].setAxisValue(AMOTION_EVENT_AXIS_PRESSURE,
+                                   pointers[i].pressure);
+            }
+
+        NotifyMotionArgs args(when, record.deviceId, record.source,
+                              record.policyFlags, record.action, record.flags,
+                              record.metaState, record.buttonState,
+                              record.edgeFlags, record.displayId,
+                              record.pointerCount, properties, coords,
+                              record.xPrecision, record.yPrecision,
+                              record.downTime + shift);
+
+        mListener->notifyMotion(&args);
+        }
+
+    mRecords++;
+
+    return true;
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_SKIWIN_INPUT_TRACE_H
+#define ANDROID_SKIWIN_INPUT_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/RefBase.h>
+#include <utils/threads.h>
+#include <utils/Timers.h>
+
+#include <input/InputListener.h>
+
+#include "SkiWinEventListener.h"
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * Input trace file layout, all fields in the byte order of the device:
+ *
+ *   SkiWinInputTraceHeader
+ *   SkiWinInputTraceRecord, each followed by pointerCount
+ *   SkiWinInputTracePointer for a motion, none for a key
+ *
+ * Keys and motions are kept as the input reader reported them to the
+ * listener, only the pointer axes other than x, y and pressure are
+ * dropped.
+ */
+
+#define SKIWIN_INPUTTRACE_MAGIC     0x54495753  /* "SWIT" */
+#define SKIWIN_INPUTTRACE_VERSION   1
+
+enum
+    {
+    SKIWIN_INPUTTRACE_KEY = 0,
+    SKIWIN_INPUTTRACE_MOTION = 1
+    };
+
+struct SkiWinInputTraceHeader
+    {
+    uint32_t magic;
+    uint32_t version;
+    };
+
+struct SkiWinInputTraceRecord
+    {
+    uint32_t type;
+    uint32_t pointerCount;
+    int64_t eventTime;
+    int64_t downTime;
+    int32_t deviceId;
+    uint32_t source;
+    uint32_t policyFlags;
+    int32_t action;
+    int32_t flags;
+    int32_t metaState;
+    int32_t keyCode;        // keys only
+    int32_t scanCode;       // keys only
+    int32_t buttonState;    // motions only from here on
+    int32_t edgeFlags;
+    int32_t displayId;
+    float xPrecision;
+    float yPrecision;
+    };
+
+struct SkiWinInputTracePointer
+    {
+    int32_t id;
+    int32_t toolType;
+    float x;
+    float y;
+    float pressure;
+    };
+
+/*
+ * SkiWinInputRecorder - Writes what the input listener is told to a trace.
+ *
+ * Called on the input reader thread only, so it takes no lock. Every
+ * record is flushed, a killed process keeps all of its trace.
+ */
+
+class SkiWinInputRecorder
+    {
+    public:
+        SkiWinInputRecorder();
+        ~SkiWinInputRecorder();
+
+        status_t open(const char* path);
+        void close();
+
+        void recordKey(const NotifyKeyArgs* args);
+        void recordMotion(const NotifyMotionArgs* args);
+
+    private:
+        void write(const void* data, size_t size);
+        void flush();
+
+        FILE* mFile;
+        uint32_t mRecords;
+    };
+
+/*
+ * SkiWinInputPlayer - Feeds a trace to an input listener in place of the
+ * input reader.
+ *
+ * Events are delivered at the pace they were recorded at, or back to
+ * back when fast, with their times moved to when they are delivered.
+ * Either way the player waits while SkiWin has no room for another event,
+ * so none is dropped.
+ */
+
+class SkiWinInputPlayer : public Thread
+    {
+    public:
+        SkiWinInputPlayer(const sp<InputListenerInterface>& listener,
+                          SkiWinEventCallback* callback, bool fast);
+        virtual ~SkiWinInputPlayer();
+
+        status_t open(const char* path);
+
+    private:
+        virtual bool threadLoop();
+
+        bool read(void* data, size_t size);
+        bool sleepUntil(nsecs_t when);
+        bool waitForRoom();
+
+        sp<InputListenerInterface> mListener;
+        SkiWinEventCallback* mCallback;
+        bool mFast;
+
+        FILE* mFile;
+        uint32_t mRecords;
+
+        // trace time of the first event, and when it was replayed
+        nsecs_t mTraceStart;
+        nsecs_t mStartTime;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_INPUT_TRACE_H
@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinMemoryBackend"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+
+#include <utils/Log.h>
+
+#include <ui/PixelFormat.h>
+#include <ui/Rect.h>
+#include <ui/Region.h>
+
+#include "SkiWinMemoryBackend.h"
+
+namespace android
+{
+
+SkiWinMemorySurface::SkiWinMemorySurface(
+    const sp<SkiWinMemoryBackend>& backend, int w, int h, PixelFormat format) :
+    mBackend(backend), mFormat(format), mWidth(w), mHeight(h)
+    {
+    mBufferWidth = 0;
+    mBufferHeight = 0;
+    mStride = 0;
+    mFront = -1;
+    mPosted = -1;
+    mLocked = -1;
+    mLastLatch = -1;
+    mLayer = 0;
+    mX = 0;
+    mY = 0;
+    mCrop = Rect(w, h);
+    mAlpha = 1.0f;
+    mMatrix[0] = 1.0f;
+    mMatrix[1] = 0.0f;
+    mMatrix[2] = 0.0f;
+    mMatrix[3] = 1.0f;
+    mVisible = false;
+    mCleared = false;
+    mPosts = 0;
+    }
+
+SkiWinMemorySurface::~SkiWinMemorySurface()
+    {
+    freeBuffers();
+    }
+
+status_t SkiWinMemorySurface::allocateBuffers()
+    {
+    ssize_t bpp = bytesPerPixel(mFormat);
+
+    if (bpp <= 0 || mWidth <= 0 || mHeight <= 0)
+        return BAD_VALUE;
+
+    // rows padded the way gralloc tends to, so strides get exercised
+    mStride = (mWidth + 7) & ~7;
+    mBufferWidth = mWidth;
+    mBufferHeight = mHeight;
+
+    for (int i = 0; i < mBackend->getBufferCount(); i++)
+        {
+        Buffer buffer;
+
+        buffer.size = mStride * mBufferHeight * bpp;
+        buffer.bits = (uint8_t*)mmap(NULL, buffer.size,
+                                     PROT_READ | PROT_WRITE,
+                                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (buffer.bits == MAP_FAILED)
+            {
+            ALOGE("cannot map %d bytes for a %dx%d buffer", buffer.size,
+                  mWidth, mHeight);
+
+            freeBuffers();
+            return NO_MEMORY;
+            }
+
+        mBuffers.add(buffer);
+        }
+
+    return NO_ERROR;
+    }
+
+void SkiWinMemorySurface::freeBuffers()
+    {
+    for (size_t i = 0; i < mBuffers.size(); i++)
+        munmap(mBuffers[i].bits, mBuffers[i].size);
+
+    mBuffers.clear();
+    mQueue.clear();
+
+    mBufferWidth = 0;
+    mBufferHeight = 0;
+    mFront = -1;
+    mPosted = -1;
+    mLocked = -1;
+    }
+
+/**
+ * latch - Put posted buffers on the fake display, one per vsync.
+ *
+ * A buffer is latched on the first vsync after it was posted that did not
+ * latch another one already.
+ */
+
+void SkiWinMemorySurface::latch(nsecs_t now)
+    {
+    while (!mQueue.isEmpty())
+        {
+        const Queued& queued = mQueue[0];
+        int64_t vsync = mBackend->getVsyncCount(queued.time) + 1;
+
+        if (vsync <= mLastLatch)
+            vsync = mLastLatch + 1;
+
+        if (mBackend->getVsyncTime(vsync) > now)
+            break;
+
+        mFront = queued.index;
+        mLastLatch = vsync;
+        mQueue.removeAt(0);
+        }
+    }
+
+int SkiWinMemorySurface::findFreeBuffer()
+    {
+    for (int i = 0; i < int(mBuffers.size()); i++)
+        {
+        bool busy = (i == mFront || i == mLocked);
+
+        for (size_t j = 0; !busy && j < mQueue.size(); j++)
+            busy = (mQueue[j].index == i);
+
+        if (!busy)
+            return i;
+        }
+
+    return -1;
+    }
+
+void SkiWinMemorySurface::copyBack(int from, int to, const Region& dirty)
+    {
+    Region copy(Region(Rect(mBufferWidth, mBufferHeight)).subtract(dirty));
+    ssize_t bpp = bytesPerPixel(mFormat);
+    size_t bpr = mStride * bpp;
+    size_t count;
+
+    const Rect* r = copy.getArray(&count);
+
+    for (; count > 0; count--, r++)
+        {
+        size_t offset = r->top * bpr + r->left * bpp;
+        const uint8_t* src = mBuffers[from].bits + offset;
+        uint8_t* dst = mBuffers[to].bits + offset;
+
+        for (int y = r->top; y < r->bottom; y++)
+            {
+            memcpy(dst, src, r->width() * bpp);
+
+            src += bpr;
+            dst += bpr;
+            }
+        }
+    }
+
+/**
+ * lock - Dequeue a free buffer, waiting for a vsync to free one if needed.
+ *
+ * Like SurfaceTextureClient, the pixels outside of the dirty region are
+ * copied back from the last posted buffer, and the dirty region grows to
+ * the whole buffer when there is none.
+ */
+
+status_t SkiWinMemorySurface::lock(SkiWinSurfaceInfo* info, Region* dirty)
+    {
+    Mutex::Autolock _l(mLock);
+
+    if (mCleared)
+        return NO_INIT;
+
+    if (mLocked >= 0)
+        return INVALID_OPERATION;
+
+    if (mBufferWidth != uint32_t(mWidth) || mBufferHeight != uint32_t(mHeight))
+        {
+        freeBuffers();
+
+        status_t err = allocateBuffers();
+        if (err != NO_ERROR)
+            return err;
+        }
+
+    int index;
+
+    for (;;)
+        {
+        nsecs_t now = systemTime();
+
+        latch(now);
+
+        index = findFreeBuffer();
+        if (index >= 0)
+            break;
+
+        // everything is queued, the next vsync latches the oldest one
+        int64_t vsync = mBackend->getVsyncCount(mQueue[0].time) + 1;
+
+        if (vsync <= mLastLatch)
+            vsync = mLastLatch + 1;
+
+        mCondition.waitRelative(mLock, mBackend->getVsyncTime(vsync) - now);
+
+        if (mCleared)
+            return NO_INIT;
+        }
+
+    Region bounds(Rect(mBufferWidth, mBufferHeight));
+    Region newDirty(bounds);
+
+    if (dirty != NULL && !dirty->isEmpty())
+        newDirty = dirty->intersect(bounds);
+
+    if (mPosted >= 0)
+        copyBack(mPosted, index, newDirty);
+    else
+        newDirty = bounds;
+
+    if (dirty != NULL)
+        *dirty = newDirty;
+
+    mLocked = index;
+
+    info->w = mBufferWidth;
+    info->h = mBufferHeight;
+    info->s = mStride;
+    info->format = mFormat;
+    info->bits = mBuffers[index].bits;
+
+    return NO_ERROR;
+    }
+
+status_t SkiWinMemorySurface::unlockAndPost()
+    {
+    Mutex::Autolock _l(mLock);
+
+    if (mLocked < 0)
+        return INVALID_OPERATION;
+
+    Queued queued;
+
+    queued.index = mLocked;
+    queued.time = systemTime();
+
+    mQueue.add(queued);
+    mPosted = mLocked;
+    mLocked = -1;
+    mPosts++;
+
+    return NO_ERROR;
+    }
+
+status_t SkiWinMemorySurface::setLayer(int32_t layer)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mLayer = layer;
+    return NO_ERROR;
+    }
+
+status_t SkiWinMemorySurface::setPosition(int x, int y)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mX = x;
+    mY = y;
+    return NO_ERROR;
+    }
+
+/* The buffers are reallocated at the next lock(), like a resized window. */
+
+status_t SkiWinMemorySurface::setSize(int w, int h)
+    {
+    Mutex::Autolock _l(mLock);
+
+    if (w <= 0 || h <= 0)
+        return BAD_VALUE;
+
+    mWidth = w;
+    mHeight = h;
+    return NO_ERROR;
+    }
+
+status_t SkiWinMemorySurface::setCrop(const Rect& crop)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mCrop = crop;
+    return NO_ERROR;
+    }
+
+status_t SkiWinMemorySurface::setAlpha(float alpha)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mAlpha = alpha;
+    return NO_ERROR;
+    }
+
+status_t SkiWinMemorySurface::setMatrix(float dsdx, float dtdx,
+                                        float dsdy, float dtdy)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mMatrix[0] = dsdx;
+    mMatrix[1] = dtdx;
+    mMatrix[2] = dsdy;
+    mMatrix[3] = dtdy;
+    return NO_ERROR;
+    }
+
+status_t SkiWinMemorySurface::show()
+    {
+    Mutex::Autolock _l(mLock);
+
+    mVisible = true;
+    return NO_ERROR;
+    }
+
+status_t SkiWinMemorySurface::hide()
+    {
+    Mutex::Autolock _l(mLock);
+
+    mVisible = false;
+    return NO_ERROR;
+    }
+
+void SkiWinMemorySurface::clear()
+    {
+    Mutex::Autolock _l(mLock);
+
+    mCleared = true;
+    mVisible = false;
+
+    // a lock() waiting for a buffer gives up
+    mCondition.broadcast();
+
+    if (mLocked < 0)
+        freeBuffers();
+    }
+
+uint32_t SkiWinMemorySurface::getPostCount()
+    {
+    Mutex::Autolock _l(mLock);
+
+    return mPosts;
+    }
+
+SkiWinMemoryBackend::SkiWinMemoryBackend(int width, int height,
+                                         int bufferCount,
+                                         nsecs_t vsyncPeriod) :
+    mWidth(width), mHeight(height), mBufferCount(bufferCount),
+    mVsyncPeriod(vsyncPeriod)
+    {
+    // one buffer on the display and one to draw into, at the very least
+    if (mBufferCount < 2)
+        mBufferCount = 2;
+
+    mVsyncStart = systemTime();
+    }
+
+SkiWinMemoryBackend::~SkiWinMemoryBackend()
+    {
+    }
+
+status_t SkiWinMemoryBackend::getDisplaySize(int* w, int* h)
+    {
+    *w = mWidth;
+    *h = mHeight;
+
+    return NO_ERROR;
+    }
+
+sp<SkiWinSurface> SkiWinMemoryBackend::createSurface(const String8& name,
+                                                     int w, int h,
+                                                     PixelFormat format)
+    {
+    if (w <= 0 || h <= 0 || bytesPerPixel(format) <= 0)
+        {
+        ALOGE("createSurface '%s' %dx%d format %d: bad arguments",
+              name.string(), w, h, format);
+        return NULL;
+        }
+
+    return new SkiWinMemorySurface(this, w, h, format);
+    }
+
+/*
+ * Nothing composes the surfaces, so property changes take effect right
+ * away and there is nothing to batch.
+ */
+
+void SkiWinMemoryBackend::openTransaction()
+    {
+    }
+
+void SkiWinMemoryBackend::closeTransaction()
+    {
+    }
+
+status_t SkiWinMemoryBackend::linkToDeath(
+    const sp<IBinder::DeathRecipient>& recipient)
+    {
+    // there is no display server that could die
+    return NO_ERROR;
+    }
+
+int64_t SkiWinMemoryBackend::getVsyncCount(nsecs_t time) const
+    {
+    if (time < mVsyncStart)
+        return 0;
+
+    return (time - mVsyncStart) / mVsyncPeriod;
+    }
+
+nsecs_t SkiWinMemoryBackend::getVsyncTime(int64_t count) const
+    {
+    return mVsyncStart + count * mVsyncPeriod;
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_MEMORY_BACKEND_H
+#define ANDROID_SKIWIN_MEMORY_BACKEND_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/threads.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+#include "SkiWinSurfaceBackend.h"
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+class SkiWinMemoryBackend;
+
+/*
+ * SkiWinMemorySurface - A buffer queue in anonymous memory.
+ *
+ * Posted buffers are latched one per vsync of the backend's fake display,
+ * like SurfaceFlinger would, which frees the buffer shown before. lock()
+ * blocks until a buffer is free, so a producer running ahead is throttled
+ * to the vsync rate the same way it is on a device.
+ */
+
+class SkiWinMemorySurface : public SkiWinSurface
+    {
+    public:
+        SkiWinMemorySurface(const sp<SkiWinMemoryBackend>& backend,
+                            int w, int h, PixelFormat format);
+        virtual ~SkiWinMemorySurface();
+
+        virtual status_t lock(SkiWinSurfaceInfo* info, Region* dirty);
+        virtual status_t unlockAndPost();
+
+        virtual status_t setLayer(int32_t layer);
+        virtual status_t setPosition(int x, int y);
+        virtual status_t setSize(int w, int h);
+        virtual status_t setCrop(const Rect& crop);
+        virtual status_t setAlpha(float alpha);
+        virtual status_t setMatrix(float dsdx, float dtdx,
+                                   float dsdy, float dtdy);
+        virtual status_t show();
+        virtual status_t hide();
+
+        virtual void clear();
+
+        uint32_t getPostCount();
+
+    private:
+        struct Buffer
+            {
+            uint8_t* bits;
+            size_t size;
+            };
+
+        struct Queued
+            {
+            int index;
+            nsecs_t time;
+            };
+
+        status_t allocateBuffers();
+        void freeBuffers();
+        void latch(nsecs_t now);
+        int findFreeBuffer();
+        void copyBack(int from, int to, const Region& dirty);
+
+        sp<SkiWinMemoryBackend> mBackend;
+
+        Mutex mLock;
+        Condition mCondition;
+
+        Vector<Buffer> mBuffers;
+        uint32_t mBufferWidth;
+        uint32_t mBufferHeight;
+        uint32_t mStride;
+        PixelFormat mFormat;
+
+        // buffer on the fake display, last posted and being drawn, or -1
+        int mFront;
+        int mPosted;
+        int mLocked;
+
+        // posted but not latched yet, oldest first
+        Vector<Queued> mQueue;
+        int64_t mLastLatch;
+
+        int32_t mLayer;
+        int mX;
+        int mY;
+        int mWidth;
+        int mHeight;
+        Rect mCrop;
+        float mAlpha;
+        float mMatrix[4];
+        bool mVisible;
+        bool mCleared;
+
+        uint32_t mPosts;
+    };
+
+/*
+ * SkiWinMemoryBackend - Surfaces without a display, for running and
+ * profiling the compositor on hosts that have none.
+ */
+
+class SkiWinMemoryBackend : public SkiWinSurfaceBackend
+    {
+    public:
+        SkiWinMemoryBackend(int width, int height, int bufferCount,
+                            nsecs_t vsyncPeriod);
+        virtual ~SkiWinMemoryBackend();
+
+        virtual const char* getName() const
+            {
+            return "memory";
+            }
+
+        virtual status_t getDisplaySize(int* w, int* h);
+
+        virtual sp<SkiWinSurface> createSurface(const String8& name,
+                                                int w, int h,
+                                                PixelFormat format);
+
+        virtual void openTransaction();
+        virtual void closeTransaction();
+
+        virtual status_t linkToDeath(
+            const sp<IBinder::DeathRecipient>& recipient);
+
+        int getBufferCount() const
+            {
+            return mBufferCount;
+            }
+
+        // vsync n happens at getVsyncTime(n), the first one at creation
+        int64_t getVsyncCount(nsecs_t time) const;
+        nsecs_t getVsyncTime(int64_t count) const;
+
+    private:
+        int mWidth;
+        int mHeight;
+        int mBufferCount;
+        nsecs_t mVsyncPeriod;
+        nsecs_t mVsyncStart;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_MEMORY_BACKEND_H
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <core/SkColorPriv.h>
+
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "SkiWinPixelConvert.h"
+
+namespace android
+{
+
+/*
+ * 4x4 ordered dither in 0..7, each row repeated so that 8 values starting
+ * at any phase can be loaded at once.
+ */
+
+static const uint8_t gDitherRows[4][12] =
+    {
+    { 0, 4, 1, 5, 0, 4, 1, 5, 0, 4, 1, 5 },
+    { 6, 2, 7, 3, 6, 2, 7, 3, 6, 2, 7, 3 },
+    { 1, 5, 0, 4, 1, 5, 0, 4, 1, 5, 0, 4 },
+    { 7, 3, 6, 2, 7, 3, 6, 2, 7, 3, 6, 2 }
+    };
+
+static inline uint16_t convertPixel(uint32_t c)
+    {
+    unsigned r = (c >> SK_R32_SHIFT) & 0xff;
+    unsigned g = (c >> SK_G32_SHIFT) & 0xff;
+    unsigned b = (c >> SK_B32_SHIFT) & 0xff;
+
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    }
+
+/*
+ * Adding d and taking away the top bits that are about to be truncated
+ * never leaves 0..255, so no clamping is needed.
+ */
+
+static inline uint16_t convertPixelDither(uint32_t c, unsigned d)
+    {
+    unsigned r = (c >> SK_R32_SHIFT) & 0xff;
+    unsigned g = (c >> SK_G32_SHIFT) & 0xff;
+    unsigned b = (c >> SK_B32_SHIFT) & 0xff;
+
+    r = r + d - (r >> 5);
+    g = g + (d >> 1) - (g >> 6);
+    b = b + d - (b >> 5);
+
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    }
+
+#if defined(__ARM_NEON__)
+
+/*
+ * 8 pixels per step, vld4 splits them into one vector per byte lane.
+ * The 565 value is built in the top bits of 16-bit lanes with shift and
+ * insert, which does the truncation for free.
+ */
+
+static int convertRowNeon(uint16_t* dst, const uint32_t* src, int count,
+                          const uint8_t* ditherRow, bool dither)
+    {
+    uint8x8_t d = vld1_u8(ditherRow);
+    uint8x8_t dg = vshr_n_u8(d, 1);
+    int i = 0;
+
+    for (; i + 8 <= count; i += 8)
+        {
+        uint8x8x4_t p = vld4_u8((const uint8_t*)(src + i));
+
+        uint8x8_t r = p.val[SK_R32_SHIFT / 8];
+        uint8x8_t g = p.val[SK_G32_SHIFT / 8];
+        uint8x8_t b = p.val[SK_B32_SHIFT / 8];
+
+        if (dither)
+            {
+            r = vsub_u8(vadd_u8(r, d), vshr_n_u8(r, 5));
+            g = vsub_u8(vadd_u8(g, dg), vshr_n_u8(g, 6));
+            b = vsub_u8(vadd_u8(b, d), vshr_n_u8(b, 5));
+            }
+
+        uint16x8_t v = vshll_n_u8(r, 8);
+        v = vsriq_n_u16(v, vshll_n_u8(g, 8), 5);
+        v = vsriq_n_u16(v, vshll_n_u8(b, 8), 11);
+
+        vst1q_u16(dst + i, v);
+        }
+
+    return i;
+    }
+
+#elif defined(__SSE2__)
+
+static inline __m128i convert4Sse2(__m128i p, __m128i d, __m128i dg,
+                                   bool dither)
+    {
+    const __m128i mask = _mm_set1_epi32(0xff);
+
+    __m128i r = _mm_and_si128(_mm_srli_epi32(p, SK_R32_SHIFT), mask);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(p, SK_G32_SHIFT), mask);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(p, SK_B32_SHIFT), mask);
+
+    if (dither)
+        {
+        r = _mm_sub_epi32(_mm_add_epi32(r, d), _mm_srli_epi32(r, 5));
+        g = _mm_sub_epi32(_mm_add_epi32(g, dg), _mm_srli_epi32(g, 6));
+        b = _mm_sub_epi32(_mm_add_epi32(b, d), _mm_srli_epi32(b, 5));
+        }
+
+    __m128i v = _mm_slli_epi32(_mm_srli_epi32(r, 3), 11);
+    v = _mm_or_si128(v, _mm_slli_epi32(_mm_srli_epi32(g, 2), 5));
+    v = _mm_or_si128(v, _mm_srli_epi32(b, 3));
+
+    // sign extend the low half so the saturating pack keeps it as is
+    return _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    }
+
+/*
+ * 8 pixels per step, two vectors of 4 packed into one of 16-bit lanes.
+ */
+
+static int convertRowSse2(uint16_t* dst, const uint32_t* src, int count,
+                          const uint8_t* ditherRow, bool dither)
+    {
+    __m128i d = _mm_set_epi32(ditherRow[3], ditherRow[2],
+                              ditherRow[1], ditherRow[0]);
+    __m128i dg = _mm_srli_epi32(d, 1);
+    int i = 0;
+
+    for (; i + 8 <= count; i += 8)
+        {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(src + i + 4));
+
+        lo = convert4Sse2(lo, d, dg, dither);
+        hi = convert4Sse2(hi, d, dg, dither);
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+        }
+
+    return i;
+    }
+
+#endif
+
+/**
+ * SkiWinConvertRow8888To565 - Convert one row of pixels.
+ *
+ * x and y are the destination position of the first pixel, they only
+ * select the dither phase.
+ */
+
+void SkiWinConvertRow8888To565(uint16_t* dst, const uint32_t* src, int count,
+                               int x, int y, bool dither)
+    {
+    const uint8_t* ditherRow = &gDitherRows[y & 3][x & 3];
+    int i = 0;
+
+#if defined(__ARM_NEON__)
+    i = convertRowNeon(dst, src, count, ditherRow, dither);
+#elif defined(__SSE2__)
+    i = convertRowSse2(dst, src, count, ditherRow, dither);
+#endif
+
+    if (dither)
+        {
+        for (; i < count; i++)
+            dst[i] = convertPixelDither(src[i], ditherRow[i & 3]);
+        }
+    else
+        {
+        for (; i < count; i++)
+            dst[i] = convertPixel(src[i]);
+        }
+    }
+
+void SkiWinConvert8888To565(void* dst, size_t dstRowBytes,
+                            const void* src, size_t srcRowBytes,
+                            int width, int height,
+                            int x, int y, bool dither)
+    {
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+
+    for (int row = 0; row < height; row++)
+        {
+        SkiWinConvertRow8888To565((uint16_t*)d, (const uint32_t*)s, width,
+                                  x, y + row, dither);
+
+        d += dstRowBytes;
+        s += srcRowBytes;
+        }
+    }
+
+const char* SkiWinPixelConvertImpl()
+    {
+#if defined(__ARM_NEON__)
+    return "neon";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "portable";
+#endif
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
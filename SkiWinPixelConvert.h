@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_PIXEL_CONVERT_H
+#define ANDROID_SKIWIN_PIXEL_CONVERT_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * Conversion of premultiplied SkPMColor pixels to RGB 565, as if composited
+ * onto black. Without dithering every channel is truncated, which matches
+ * what Skia writes for opaque pixels. With dithering a 4x4 ordered dither
+ * is added before truncating, its phase taken from the destination x, y so
+ * neighbouring updates line up.
+ *
+ * NEON and SSE2 builds convert 8 and 4 pixels at a time, the results are
+ * the same as the portable version bit for bit.
+ */
+
+void SkiWinConvertRow8888To565(uint16_t* dst, const uint32_t* src, int count,
+                               int x, int y, bool dither);
+
+void SkiWinConvert8888To565(void* dst, size_t dstRowBytes,
+                            const void* src, size_t srcRowBytes,
+                            int width, int height,
+                            int x, int y, bool dither);
+
+const char* SkiWinPixelConvertImpl();
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_PIXEL_CONVERT_H
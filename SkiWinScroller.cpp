@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define LOG_TAG "SkiWinScroller"
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include "SkiWinScroller.h"
+
+// in pixels per second, and per second squared for the deceleration
+#define FLING_DECELERATION      2000.0f
+#define FLING_MIN_VELOCITY      100.0f
+#define FLING_MAX_VELOCITY      8000.0f
+
+// a finger resting this long before it lifts does not fling
+#define FLING_MAX_PAUSE         ms2ns(100)
+
+// weight of the latest move in the velocity, the rest is history
+#define VELOCITY_WEIGHT         0.6f
+
+namespace android
+{
+
+SkiWinScroller::SkiWinScroller(nsecs_t frameInterval) :
+    mFrameInterval(frameInterval)
+    {
+    mRange = 0;
+    mPosition = 0;
+    mReported = 0;
+    mDirection = 0;
+
+    mDragging = false;
+    mLastY = 0;
+    mLastTime = 0;
+    mVelocity = 0;
+
+    mFlinging = false;
+    mFlingStart = 0;
+    mFlingVelocity = 0;
+    mFlingTime = 0;
+    mNextStep = 0;
+    }
+
+/**
+ * setRange - Set how far the content scrolls, its height less the view's.
+ */
+
+void SkiWinScroller::setRange(int range)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mRange = range > 0 ? range : 0;
+    moveLocked(mPosition);
+    }
+
+void SkiWinScroller::moveLocked(float position)
+    {
+    if (position < 0)
+        position = 0;
+    else if (position > mRange)
+        position = mRange;
+
+    if (position != mPosition)
+        mDirection = position > mPosition ? 1 : -1;
+
+    mPosition = position;
+    }
+
+/**
+ * touchDown - Start a drag, catching any fling still running.
+ */
+
+void SkiWinScroller::touchDown(int y, nsecs_t when)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mFlinging = false;
+    mDragging = true;
+    mLastY = y;
+    mLastTime = when;
+    mVelocity = 0;
+    }
+
+/**
+ * touchMove - Move the content with the finger.
+ *
+ * Moving the finger up scrolls the content towards its end.
+ */
+
+void SkiWinScroller::touchMove(int y, nsecs_t when)
+    {
+    Mutex::Autolock _l(mLock);
+
+    if (!mDragging)
+        return;
+
+    int dy = mLastY - y;
+
+    if (when > mLastTime)
+        {
+        float velocity = dy * 1e9f / (when - mLastTime);
+
+        mVelocity = mVelocity * (1.0f - VELOCITY_WEIGHT) +
+                    velocity * VELOCITY_WEIGHT;
+        }
+
+    moveLocked(mPosition + dy);
+
+    mLastY = y;
+    mLastTime = when;
+    }
+
+/**
+ * touchUp - End a drag, flinging on if the finger was still moving.
+ */
+
+void SkiWinScroller::touchUp(int y, nsecs_t when)
+    {
+    touchMove(y, when);
+
+    Mutex::Autolock _l(mLock);
+
+    if (!mDragging)
+        return;
+
+    mDragging = false;
+
+    if (when - mLastTime > FLING_MAX_PAUSE ||
+        fabsf(mVelocity) < FLING_MIN_VELOCITY)
+        return;
+
+    if (mVelocity > FLING_MAX_VELOCITY)
+        mVelocity = FLING_MAX_VELOCITY;
+    else if (mVelocity < -FLING_MAX_VELOCITY)
+        mVelocity = -FLING_MAX_VELOCITY;
+
+    mFlinging = true;
+    mFlingStart = mPosition;
+    mFlingVelocity = mVelocity;
+    mFlingTime = systemTime();
+    mNextStep = 0;
+    }
+
+/**
+ * touchCancel - End a drag where it is, without flinging.
+ */
+
+void SkiWinScroller::touchCancel()
+    {
+    Mutex::Autolock _l(mLock);
+
+    mDragging = false;
+    }
+
+/**
+ * getDirection - Which way the content is moving, 0 when it is at rest.
+ */
+
+int SkiWinScroller::getDirection()
+    {
+    Mutex::Autolock _l(mLock);
+
+    return mDragging || mFlinging ? mDirection : 0;
+    }
+
+/**
+ * getNextStepTime - When a fling moves on, LLONG_MAX if there is none.
+ */
+
+nsecs_t SkiWinScroller::getNextStepTime()
+    {
+    Mutex::Autolock _l(mLock);
+
+    return mFlinging ? mNextStep : LLONG_MAX;
+    }
+
+/**
+ * step - Advance a fling to now and get the position to draw.
+ *
+ * Returns true if the position changed since the last step, by a drag or
+ * a fling. A fling steps at most once per frame interval.
+ */
+
+bool SkiWinScroller::step(nsecs_t now, int* position)
+    {
+    Mutex::Autolock _l(mLock);
+
+    if (mFlinging && now >= mNextStep)
+        {
+        float t = (now - mFlingTime) / 1e9f;
+        float stop = fabsf(mFlingVelocity) / FLING_DECELERATION;
+        float deceleration = mFlingVelocity > 0 ? FLING_DECELERATION :
+                                                  -FLING_DECELERATION;
+
+        if (t >= stop)
+            {
+            t = stop;
+            mFlinging = false;
+            }
+
+        float target = mFlingStart + mFlingVelocity * t -
+                       deceleration * t * t / 2;
+
+        moveLocked(target);
+
+        // either end of the content stops it
+        if (mPosition != target)
+            mFlinging = false;
+
+        mNextStep = now + mFrameInterval;
+        }
+
+    int current = int(floorf(mPosition + 0.5f));
+
+    *position = current;
+
+    if (current == mReported)
+        return false;
+
+    mReported = current;
+    return true;
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
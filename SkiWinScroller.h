@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_SKIWIN_SCROLLER_H
+#define ANDROID_SKIWIN_SCROLLER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/threads.h>
+#include <utils/Timers.h>
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * SkiWinScroller - Vertical scroll position driven by drags and flings.
+ *
+ * A drag moves the position with the finger. Lifting the finger while it
+ * still moves flings on at that velocity, slowing down at a constant rate
+ * until it stops or hits either end of the range.
+ *
+ * The SkiWin thread feeds it the touches it dispatches before a frame and
+ * picks up the position with step() for the frame, flings advancing one
+ * frame interval per step.
+ */
+
+class SkiWinScroller
+    {
+    public:
+        SkiWinScroller(nsecs_t frameInterval);
+
+        void setRange(int range);
+
+        void touchDown(int y, nsecs_t when);
+        void touchMove(int y, nsecs_t when);
+        void touchUp(int y, nsecs_t when);
+        void touchCancel();
+
+        int getDirection();
+        nsecs_t getNextStepTime();
+        bool step(nsecs_t now, int* position);
+
+    private:
+        void moveLocked(float position);
+
+        nsecs_t mFrameInterval;
+
+        Mutex mLock;
+
+        int mRange;
+        float mPosition;
+        int mReported;
+        int mDirection;
+
+        // last touch and the velocity it moved at, pixels per second
+        bool mDragging;
+        int mLastY;
+        nsecs_t mLastTime;
+        float mVelocity;
+
+        // fling start, the position follows from the time since
+        bool mFlinging;
+        float mFlingStart;
+        float mFlingVelocity;
+        nsecs_t mFlingTime;
+        nsecs_t mNextStep;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_SCROLLER_H
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinSurfaceBackend"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <cutils/properties.h>
+#include <utils/Log.h>
+
+#include "SkiWinMemoryBackend.h"
+#include "SkiWinSurfaceBackend.h"
+#include "SkiWinSurfaceFlingerBackend.h"
+
+#define BACKEND_PROP_NAME "debug.skiwin.backend"
+#define BACKEND_ENV_NAME "SKIWIN_BACKEND"
+
+// fake display of the memory backend, "<width>x<height>"
+#define MEMORY_SIZE_PROP_NAME "debug.skiwin.memory.size"
+#define MEMORY_DEFAULT_WIDTH            320
+#define MEMORY_DEFAULT_HEIGHT           480
+
+// 2 for double, 3 for triple buffering
+#define MEMORY_BUFFERS_PROP_NAME "debug.skiwin.memory.buffers"
+#define MEMORY_DEFAULT_BUFFERS          3
+
+#define MEMORY_VSYNC_PERIOD             (s2ns(1) / 60)
+
+namespace android
+{
+
+sp<SkiWinSurfaceBackend> SkiWinSurfaceBackend::create(const char* name)
+    {
+    char value[PROPERTY_VALUE_MAX];
+
+    if (name == NULL)
+        {
+        const char* env = getenv(BACKEND_ENV_NAME);
+
+        property_get(BACKEND_PROP_NAME, value,
+                     env ? env : "surfaceflinger");
+        name = value;
+        }
+
+    if (!strcmp(name, "surfaceflinger"))
+        return new SkiWinSurfaceFlingerBackend();
+
+    if (!strcmp(name, "memory"))
+        {
+        int width = MEMORY_DEFAULT_WIDTH;
+        int height = MEMORY_DEFAULT_HEIGHT;
+        int buffers = MEMORY_DEFAULT_BUFFERS;
+
+        if (property_get(MEMORY_SIZE_PROP_NAME, value, NULL) > 0 &&
+            sscanf(value, "%dx%d", &width, &height) != 2)
+            {
+            ALOGW("ignoring %s=%s", MEMORY_SIZE_PROP_NAME, value);
+
+            width = MEMORY_DEFAULT_WIDTH;
+            height = MEMORY_DEFAULT_HEIGHT;
+            }
+
+        if (property_get(MEMORY_BUFFERS_PROP_NAME, value, NULL) > 0)
+            buffers = atoi(value);
+
+        ALOGD("memory backend %dx%d, %d buffers", width, height, buffers);
+
+        return new SkiWinMemoryBackend(width, height, buffers,
+                                       MEMORY_VSYNC_PERIOD);
+        }
+
+    ALOGE("unknown surface backend '%s'", name);
+
+    return NULL;
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_SURFACE_BACKEND_H
+#define ANDROID_SKIWIN_SURFACE_BACKEND_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <binder/IBinder.h>
+#include <ui/PixelFormat.h>
+#include <ui/Region.h>
+#include <utils/Errors.h>
+#include <utils/RefBase.h>
+#include <utils/String8.h>
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/* A locked buffer, laid out like Surface::SurfaceInfo. */
+
+struct SkiWinSurfaceInfo
+    {
+    uint32_t w;
+    uint32_t h;
+    uint32_t s;         // stride in pixels
+    PixelFormat format;
+    void* bits;
+    };
+
+/*
+ * SkiWinSurface - One surface of a backend, drawn through lock() and
+ * unlockAndPost() and placed on the display by its properties.
+ *
+ * lock() takes the region about to be drawn and may widen it, the pixels
+ * outside of the returned region hold what was last posted. Property
+ * changes made between openTransaction() and closeTransaction() of the
+ * backend take effect together.
+ */
+
+class SkiWinSurface : public RefBase
+    {
+    public:
+        virtual ~SkiWinSurface() {}
+
+        virtual status_t lock(SkiWinSurfaceInfo* info, Region* dirty) = 0;
+        virtual status_t unlockAndPost() = 0;
+
+        virtual status_t setLayer(int32_t layer) = 0;
+        virtual status_t setPosition(int x, int y) = 0;
+        virtual status_t setSize(int w, int h) = 0;
+        virtual status_t setCrop(const Rect& crop) = 0;
+        virtual status_t setAlpha(float alpha) = 0;
+        virtual status_t setMatrix(float dsdx, float dtdx,
+                                   float dsdy, float dtdy) = 0;
+        virtual status_t show() = 0;
+        virtual status_t hide() = 0;
+
+        // give up the surface, it is not shown or drawn into again
+        virtual void clear() = 0;
+    };
+
+/*
+ * SkiWinSurfaceBackend - Where the surfaces of the SkiWin views come from.
+ *
+ * "surfaceflinger" puts them on the display, "memory" keeps them in
+ * anonymous memory with a fake vsync, so the compositor runs without a
+ * display. create() picks one by name, NULL meaning the
+ * debug.skiwin.backend property, or SKIWIN_BACKEND in the environment.
+ */
+
+class SkiWinSurfaceBackend : public RefBase
+    {
+    public:
+        virtual ~SkiWinSurfaceBackend() {}
+
+        static sp<SkiWinSurfaceBackend> create(const char* name = NULL);
+
+        virtual const char* getName() const = 0;
+
+        virtual status_t getDisplaySize(int* w, int* h) = 0;
+
+        virtual sp<SkiWinSurface> createSurface(const String8& name,
+                                                int w, int h,
+                                                PixelFormat format) = 0;
+
+        virtual void openTransaction() = 0;
+        virtual void closeTransaction() = 0;
+
+        // recipient is told when the display server goes away
+        virtual status_t linkToDeath(
+            const sp<IBinder::DeathRecipient>& recipient) = 0;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_SURFACE_BACKEND_H
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinSurfaceFlingerBackend"
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include <ui/DisplayInfo.h>
+
+#include <gui/ISurfaceComposer.h>
+#include <gui/Surface.h>
+#include <gui/SurfaceComposerClient.h>
+
+#include "SkiWinSurfaceFlingerBackend.h"
+
+namespace android
+{
+
+SkiWinSurfaceFlingerSurface::SkiWinSurfaceFlingerSurface(
+    const sp<SurfaceControl>& control) : mSurfaceControl(control)
+    {
+    mSurface = mSurfaceControl->getSurface();
+    }
+
+SkiWinSurfaceFlingerSurface::~SkiWinSurfaceFlingerSurface()
+    {
+    mSurfaceControl = NULL;
+    mSurface = NULL;
+    }
+
+status_t SkiWinSurfaceFlingerSurface::lock(SkiWinSurfaceInfo* info,
+                                           Region* dirty)
+    {
+    Surface::SurfaceInfo si;
+
+    status_t err = mSurface->lock(&si, dirty);
+    if (err != NO_ERROR)
+        return err;
+
+    info->w = si.w;
+    info->h = si.h;
+    info->s = si.s;
+    info->format = si.format;
+    info->bits = si.bits;
+
+    return NO_ERROR;
+    }
+
+status_t SkiWinSurfaceFlingerSurface::unlockAndPost()
+    {
+    return mSurface->unlockAndPost();
+    }
+
+status_t SkiWinSurfaceFlingerSurface::setLayer(int32_t layer)
+    {
+    return mSurfaceControl->setLayer(layer);
+    }
+
+status_t SkiWinSurfaceFlingerSurface::setPosition(int x, int y)
+    {
+    return mSurfaceControl->setPosition(x, y);
+    }
+
+status_t SkiWinSurfaceFlingerSurface::setSize(int w, int h)
+    {
+    return mSurfaceControl->setSize(w, h);
+    }
+
+status_t SkiWinSurfaceFlingerSurface::setCrop(const Rect& crop)
+    {
+    return mSurfaceControl->setCrop(crop);
+    }
+
+status_t SkiWinSurfaceFlingerSurface::setAlpha(float alpha)
+    {
+    return mSurfaceControl->setAlpha(alpha);
+    }
+
+status_t SkiWinSurfaceFlingerSurface::setMatrix(float dsdx, float dtdx,
+                                                float dsdy, float dtdy)
+    {
+    return mSurfaceControl->setMatrix(dsdx, dtdx, dsdy, dtdy);
+    }
+
+status_t SkiWinSurfaceFlingerSurface::show()
+    {
+    return mSurfaceControl->show();
+    }
+
+status_t SkiWinSurfaceFlingerSurface::hide()
+    {
+    return mSurfaceControl->hide();
+    }
+
+void SkiWinSurfaceFlingerSurface::clear()
+    {
+    mSurfaceControl->clear();
+    }
+
+SkiWinSurfaceFlingerBackend::SkiWinSurfaceFlingerBackend()
+    {
+    mSession = new SurfaceComposerClient();
+    }
+
+SkiWinSurfaceFlingerBackend::~SkiWinSurfaceFlingerBackend()
+    {
+    mSession = NULL;
+    }
+
+status_t SkiWinSurfaceFlingerBackend::getDisplaySize(int* w, int* h)
+    {
+    DisplayInfo dinfo;
+
+    sp<IBinder> dtoken(SurfaceComposerClient::getBuiltInDisplay(
+                           ISurfaceComposer::eDisplayIdMain));
+
+    status_t status = SurfaceComposerClient::getDisplayInfo(dtoken, &dinfo);
+    if (status)
+        return status;
+
+    *w = dinfo.w;
+    *h = dinfo.h;
+
+    return NO_ERROR;
+    }
+
+sp<SkiWinSurface> SkiWinSurfaceFlingerBackend::createSurface(
+    const String8& name, int w, int h, PixelFormat format)
+    {
+    sp<SurfaceControl> control = mSession->createSurface(name, w, h, format);
+
+    if (control == NULL || !control->isValid())
+        {
+        ALOGE("createSurface '%s' %dx%d failed", name.string(), w, h);
+        return NULL;
+        }
+
+    return new SkiWinSurfaceFlingerSurface(control);
+    }
+
+void SkiWinSurfaceFlingerBackend::openTransaction()
+    {
+    SurfaceComposerClient::openGlobalTransaction();
+    }
+
+void SkiWinSurfaceFlingerBackend::closeTransaction()
+    {
+    SurfaceComposerClient::closeGlobalTransaction();
+    }
+
+status_t SkiWinSurfaceFlingerBackend::linkToDeath(
+    const sp<IBinder::DeathRecipient>& recipient)
+    {
+    return mSession->linkToComposerDeath(recipient);
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
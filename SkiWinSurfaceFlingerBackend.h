@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_SURFACE_FLINGER_BACKEND_H
+#define ANDROID_SKIWIN_SURFACE_FLINGER_BACKEND_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <gui/Surface.h>
+#include <gui/SurfaceComposerClient.h>
+
+#include "SkiWinSurfaceBackend.h"
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+class SkiWinSurfaceFlingerSurface : public SkiWinSurface
+    {
+    public:
+        SkiWinSurfaceFlingerSurface(const sp<SurfaceControl>& control);
+        virtual ~SkiWinSurfaceFlingerSurface();
+
+        virtual status_t lock(SkiWinSurfaceInfo* info, Region* dirty);
+        virtual status_t unlockAndPost();
+
+        virtual status_t setLayer(int32_t layer);
+        virtual status_t setPosition(int x, int y);
+        virtual status_t setSize(int w, int h);
+        virtual status_t setCrop(const Rect& crop);
+        virtual status_t setAlpha(float alpha);
+        virtual status_t setMatrix(float dsdx, float dtdx,
+                                   float dsdy, float dtdy);
+        virtual status_t show();
+        virtual status_t hide();
+
+        virtual void clear();
+
+    private:
+        sp<SurfaceControl> mSurfaceControl;
+        sp<Surface> mSurface;
+    };
+
+/*
+ * SkiWinSurfaceFlingerBackend - Surfaces composed by SurfaceFlinger.
+ *
+ * Transactions are SurfaceComposerClient global transactions.
+ */
+
+class SkiWinSurfaceFlingerBackend : public SkiWinSurfaceBackend
+    {
+    public:
+        SkiWinSurfaceFlingerBackend();
+        virtual ~SkiWinSurfaceFlingerBackend();
+
+        virtual const char* getName() const
+            {
+            return "surfaceflinger";
+            }
+
+        virtual status_t getDisplaySize(int* w, int* h);
+
+        virtual sp<SkiWinSurface> createSurface(const String8& name,
+                                                int w, int h,
+                                                PixelFormat format);
+
+        virtual void openTransaction();
+        virtual void closeTransaction();
+
+        virtual status_t linkToDeath(
+            const sp<IBinder::DeathRecipient>& recipient);
+
+    private:
+        sp<SurfaceComposerClient> mSession;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_SURFACE_FLINGER_BACKEND_H
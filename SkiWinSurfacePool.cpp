@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define LOG_TAG "SkiWinSurfacePool"
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include "SkiWinSurfacePool.h"
+
+// buffers a surface is assumed to hold when accounting idle bytes
+#define POOL_BUFFER_COUNT   2
+
+namespace android
+{
+
+SkiWinSurfacePool::SkiWinSurfacePool(const sp<SkiWinSurfaceBackend>& backend,
+                                     size_t budget) :
+    mBackend(backend), mIdleBytes(0), mBudget(budget),
+    mHits(0), mMisses(0), mEvictions(0)
+    {
+    }
+
+SkiWinSurfacePool::~SkiWinSurfacePool()
+    {
+    purge();
+    }
+
+/**
+ * bucketSize - Round a window dimension up to the size it is allocated at.
+ *
+ * 32 pixel steps up to 256, 64 up to 1024 and 128 beyond, so a surface is
+ * never more than an eighth or so larger than the window it carries.
+ */
+
+int SkiWinSurfacePool::bucketSize(int size)
+    {
+    int step = size <= 256 ? 32 : size <= 1024 ? 64 : 128;
+
+    if (size < 1)
+        size = 1;
+
+    return (size + step - 1) & ~(step - 1);
+    }
+
+size_t SkiWinSurfacePool::bytesOf(int w, int h, PixelFormat format)
+    {
+    ssize_t bpp = bytesPerPixel(format);
+
+    if (bpp < 0)
+        bpp = 0;
+
+    return size_t(w) * h * bpp * POOL_BUFFER_COUNT;
+    }
+
+/**
+ * acquire - Get a surface able to show a w x h window.
+ *
+ * An idle surface of the same bucket and format is reused as is, otherwise
+ * a new one is created at the bucket size. Either way it is hidden, its
+ * buffer size is returned in bufferWidth and bufferHeight.
+ */
+
+sp<SkiWinSurface> SkiWinSurfacePool::acquire(const String8& name,
+                                             int w, int h,
+                                             PixelFormat format,
+                                             int* bufferWidth,
+                                             int* bufferHeight)
+    {
+    int bw = bucketSize(w);
+    int bh = bucketSize(h);
+
+        {
+        Mutex::Autolock _l(mLock);
+
+        // most recently released first, its buffers are the warmest
+        for (size_t i = mIdle.size(); i > 0; i--)
+            {
+            const Entry& entry = mIdle[i - 1];
+
+            if (entry.w != bw || entry.h != bh || entry.format != format)
+                continue;
+
+            sp<SkiWinSurface> surface = entry.surface;
+
+            mIdleBytes -= entry.bytes;
+            mIdle.removeAt(i - 1);
+            mHits++;
+
+            *bufferWidth = bw;
+            *bufferHeight = bh;
+
+            return surface;
+            }
+
+        mMisses++;
+        }
+
+    sp<SkiWinSurface> surface = mBackend->createSurface(name, bw, bh, format);
+
+    if (surface == NULL)
+        {
+        ALOGE("no surface for %s (%dx%d)", name.string(), bw, bh);
+        return NULL;
+        }
+
+    *bufferWidth = bw;
+    *bufferHeight = bh;
+
+    return surface;
+    }
+
+/**
+ * release - Keep the surface of a closed window for reuse.
+ *
+ * The caller has hidden it already, usually in the transaction that
+ * closed the window.
+ */
+
+void SkiWinSurfacePool::release(const sp<SkiWinSurface>& surface,
+                                int bufferWidth, int bufferHeight,
+                                PixelFormat format)
+    {
+    if (surface == NULL)
+        return;
+
+    Entry entry;
+
+    entry.surface = surface;
+    entry.w = bufferWidth;
+    entry.h = bufferHeight;
+    entry.format = format;
+    entry.bytes = bytesOf(bufferWidth, bufferHeight, format);
+
+    Mutex::Autolock _l(mLock);
+
+    // a surface of an odd size never comes back out, don't keep it
+    if (entry.w != bucketSize(entry.w) || entry.h != bucketSize(entry.h))
+        return;
+
+    mIdle.add(entry);
+    mIdleBytes += entry.bytes;
+
+    trimLocked(mBudget);
+    }
+
+void SkiWinSurfacePool::setBudget(size_t budget)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mBudget = budget;
+    trimLocked(mBudget);
+    }
+
+void SkiWinSurfacePool::purge()
+    {
+    Mutex::Autolock _l(mLock);
+
+    trimLocked(0);
+    }
+
+void SkiWinSurfacePool::trimLocked(size_t budget)
+    {
+    while (mIdleBytes > budget && !mIdle.isEmpty())
+        {
+        mIdleBytes -= mIdle[0].bytes;
+        mIdle.removeAt(0);
+        mEvictions++;
+        }
+    }
+
+void SkiWinSurfacePool::dump()
+    {
+    Mutex::Autolock _l(mLock);
+
+    ALOGD("surface pool: %d idle, %d/%d bytes, hits %u misses %u evictions %u",
+          int(mIdle.size()), int(mIdleBytes), int(mBudget),
+          mHits, mMisses, mEvictions);
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
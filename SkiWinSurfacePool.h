@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_SKIWIN_SURFACE_POOL_H
+#define ANDROID_SKIWIN_SURFACE_POOL_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <ui/PixelFormat.h>
+#include <utils/RefBase.h>
+#include <utils/String8.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+#include "SkiWinSurfaceBackend.h"
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * SkiWinSurfacePool - Surfaces of closed windows kept for the next ones.
+ *
+ * Surfaces are allocated at a bucket size, each dimension rounded up, and
+ * a window is cropped to its own size within it. A window opening in the
+ * same bucket and format as one closed before takes over its surface and
+ * buffers, which costs a crop instead of a surface and its allocations.
+ *
+ * Idle surfaces are hidden and count against a byte budget, the longest
+ * idle ones are destroyed first when it is exceeded.
+ */
+
+class SkiWinSurfacePool
+    {
+    public:
+        SkiWinSurfacePool(const sp<SkiWinSurfaceBackend>& backend,
+                          size_t budget);
+        ~SkiWinSurfacePool();
+
+        static int bucketSize(int size);
+
+        sp<SkiWinSurface> acquire(const String8& name, int w, int h,
+                                  PixelFormat format,
+                                  int* bufferWidth, int* bufferHeight);
+        void release(const sp<SkiWinSurface>& surface,
+                     int bufferWidth, int bufferHeight, PixelFormat format);
+
+        void setBudget(size_t budget);
+        void purge();
+        void dump();
+
+    private:
+        struct Entry
+            {
+            sp<SkiWinSurface> surface;
+            int w;
+            int h;
+            PixelFormat format;
+            size_t bytes;
+            };
+
+        static size_t bytesOf(int w, int h, PixelFormat format);
+        void trimLocked(size_t budget);
+
+        sp<SkiWinSurfaceBackend> mBackend;
+
+        Mutex mLock;
+
+        // idle surfaces, longest idle first
+        Vector<Entry> mIdle;
+        size_t mIdleBytes;
+        size_t mBudget;
+
+        uint32_t mHits;
+        uint32_t mMisses;
+        uint32_t mEvictions;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_SURFACE_POOL_H
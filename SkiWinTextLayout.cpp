@@ -0,0 +1,393 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinTextLayout"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include <core/SkCanvas.h>
+#include <core/SkPaint.h>
+#include <core/SkTypeface.h>
+#include <core/SkUtils.h>
+
+#include "SkiWinHash.h"
+#include "SkiWinTextLayout.h"
+
+namespace android
+{
+
+/**
+ * breakLine - Find the end of the line starting at text.
+ *
+ * Returns the number of bytes the line takes, including the '\n' ending
+ * it, and sets *len to the number of bytes to draw.
+ */
+
+static size_t breakLine(const char* text, const char* stop,
+                        const SkPaint& paint, SkScalar width, size_t* len)
+    {
+    const char* eol = (const char*)memchr(text, '\n', stop - text);
+
+    if (eol == NULL)
+        eol = stop;
+
+    size_t n = eol - text;
+
+    if (width > 0 && n > 0)
+        {
+        size_t fit = paint.breakText(text, n, width);
+
+        if (fit == 0)
+            {
+            // not even one character fits, take it anyway to make progress
+            fit = SkUTF8_LeadByteToCount(*text);
+            }
+
+        if (fit < n)
+            {
+            // break after the last space that fits, if there is one
+            size_t space = fit;
+
+            while (space > 0 && text[space - 1] != ' ')
+                space--;
+
+            n = space > 0 ? space : fit;
+
+            *len = n;
+            return n;
+            }
+        }
+
+    *len = n;
+
+    if (n > 0 && text[n - 1] == '\r')
+        (*len)--;
+
+    return eol < stop ? n + 1 : n;
+    }
+
+SkiWinTextLayout::SkiWinTextLayout()
+    {
+    mLineCount = 0;
+    mTextHeight = 0;
+    mBaseline = 0;
+    mGlyphTop = 0;
+    mGlyphBottom = 0;
+    }
+
+/**
+ * layout - Break the text into lines and shape the ones that are drawn.
+ *
+ * Baselines are placed like SkTextBox::draw() places them, the first one
+ * an ascent below the top, the next ones the font spacing scaled by
+ * spacingMul plus spacingAdd apart. A width of 0 does not break lines, a
+ * height of 0 keeps every line.
+ */
+
+void SkiWinTextLayout::layout(const char text[], size_t len,
+                              const SkPaint& paint,
+                              SkScalar width, SkScalar height,
+                              SkScalar spacingMul, SkScalar spacingAdd)
+    {
+    SkPaint::FontMetrics metrics;
+    SkScalar fontHeight = paint.getFontMetrics(&metrics);
+    SkScalar spacing = SkScalarMul(fontHeight, spacingMul) + spacingAdd;
+
+    SkPaint glyphPaint(paint);
+    glyphPaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+    const char* stop = text + len;
+    SkScalar y = -metrics.fAscent;
+    Vector<SkScalar> widths;
+
+    mLines.clear();
+    mGlyphs.clear();
+    mPositions.clear();
+    mLineCount = 0;
+    mBaseline = y;
+    mGlyphTop = metrics.fTop;
+    mGlyphBottom = metrics.fBottom;
+
+    while (text < stop)
+        {
+        size_t n;
+        size_t used = breakLine(text, stop, paint, width, &n);
+
+        if ((height <= 0 || y + metrics.fAscent < height) && n > 0)
+            {
+            Line line;
+            line.start = mGlyphs.size();
+            line.count = paint.textToGlyphs(text, n, NULL);
+
+            mGlyphs.insertAt(0, line.start, line.count);
+            paint.textToGlyphs(text, n, mGlyphs.editArray() + line.start);
+
+            widths.resize(line.count);
+            glyphPaint.getTextWidths(mGlyphs.array() + line.start,
+                                     line.count * sizeof(uint16_t),
+                                     widths.editArray());
+
+            SkScalar x = 0;
+
+            for (uint32_t i = 0; i < line.count; i++)
+                {
+                mPositions.add(SkPoint::Make(x, y));
+                x += widths[i];
+                }
+
+            mLines.add(line);
+            }
+
+        mLineCount++;
+        y += spacing;
+        text += used;
+        }
+
+    mTextHeight = mLineCount ? fontHeight + spacing * (mLineCount - 1) : 0;
+    }
+
+/**
+ * draw - Draw the shaped lines with the top left of the box at x, y.
+ *
+ * Lines entirely outside the clip are skipped, so drawing a small part of
+ * a long text costs only the lines in that part.
+ */
+
+void SkiWinTextLayout::draw(SkCanvas* canvas, SkScalar x, SkScalar y,
+                            const SkPaint& paint) const
+    {
+    SkPaint glyphPaint(paint);
+    glyphPaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+    SkAutoCanvasRestore acr(canvas, true);
+
+    canvas->translate(x, y);
+
+    SkRect clip;
+
+    if (!canvas->getClipBounds(&clip))
+        return;
+
+    for (size_t i = 0; i < mLines.size(); i++)
+        {
+        const Line& line = mLines[i];
+        SkScalar baseline = mPositions[line.start].fY;
+
+        if (baseline + mGlyphBottom < clip.fTop ||
+            baseline + mGlyphTop > clip.fBottom)
+            continue;
+
+        canvas->drawPosText(mGlyphs.array() + line.start,
+                            line.count * sizeof(uint16_t),
+                            mPositions.array() + line.start, glyphPaint);
+        }
+    }
+
+size_t SkiWinTextLayout::getBytes() const
+    {
+    return sizeof(*this) +
+           mLines.size() * sizeof(Line) +
+           mGlyphs.size() * (sizeof(uint16_t) + sizeof(SkPoint));
+    }
+
+bool SkiWinTextLayoutCache::Key::operator<(const Key& rhs) const
+    {
+    if (hash != rhs.hash)
+        return hash < rhs.hash;
+    if (len != rhs.len)
+        return len < rhs.len;
+    if (typeface != rhs.typeface)
+        return typeface < rhs.typeface;
+    if (flags != rhs.flags)
+        return flags < rhs.flags;
+    if (textSize != rhs.textSize)
+        return textSize < rhs.textSize;
+    if (textScaleX != rhs.textScaleX)
+        return textScaleX < rhs.textScaleX;
+    if (textSkewX != rhs.textSkewX)
+        return textSkewX < rhs.textSkewX;
+    if (width != rhs.width)
+        return width < rhs.width;
+    if (height != rhs.height)
+        return height < rhs.height;
+    if (spacingMul != rhs.spacingMul)
+        return spacingMul < rhs.spacingMul;
+    return spacingAdd < rhs.spacingAdd;
+    }
+
+SkiWinTextLayoutCache::SkiWinTextLayoutCache(size_t budget)
+    {
+    mHead = NULL;
+    mTail = NULL;
+    mBudget = budget;
+    mUsed = 0;
+    mHits = 0;
+    mMisses = 0;
+    mEvictions = 0;
+    }
+
+SkiWinTextLayoutCache::~SkiWinTextLayoutCache()
+    {
+    purge();
+    }
+
+void SkiWinTextLayoutCache::unlink(Entry* entry)
+    {
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        mHead = entry->next;
+
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        mTail = entry->prev;
+
+    entry->prev = NULL;
+    entry->next = NULL;
+    }
+
+void SkiWinTextLayoutCache::pushFront(Entry* entry)
+    {
+    entry->prev = NULL;
+    entry->next = mHead;
+
+    if (mHead)
+        mHead->prev = entry;
+    else
+        mTail = entry;
+
+    mHead = entry;
+    }
+
+void SkiWinTextLayoutCache::trim(size_t budget)
+    {
+    while (mTail && mUsed > budget)
+        {
+        Entry* victim = mTail;
+
+        unlink(victim);
+        mEntries.removeItem(victim->key);
+        mUsed -= victim->bytes;
+        mEvictions++;
+
+        delete victim;
+        }
+    }
+
+/**
+ * get - Layout of the text for the paint and box, reusing a previous one.
+ *
+ * Only the paint's typeface, size, scale, skew and flags take part, the
+ * color and other drawing state can differ between uses of a layout.
+ */
+
+sp<SkiWinTextLayout> SkiWinTextLayoutCache::get(const char text[], size_t len,
+                                                const SkPaint& paint,
+                                                SkScalar width,
+                                                SkScalar height,
+                                                SkScalar spacingMul,
+                                                SkScalar spacingAdd)
+    {
+    Key key;
+
+    key.hash = SkiWinHash64(text, len);
+    key.len = len;
+    key.typeface = SkTypeface::UniqueID(paint.getTypeface());
+    key.flags = paint.getFlags();
+    key.textSize = paint.getTextSize();
+    key.textScaleX = paint.getTextScaleX();
+    key.textSkewX = paint.getTextSkewX();
+    key.width = width;
+    key.height = height;
+    key.spacingMul = spacingMul;
+    key.spacingAdd = spacingAdd;
+
+        {
+        Mutex::Autolock _l(mLock);
+
+        ssize_t index = mEntries.indexOfKey(key);
+
+        if (index >= 0)
+            {
+            Entry* entry = mEntries.valueAt(index);
+
+            unlink(entry);
+            pushFront(entry);
+            mHits++;
+
+            return entry->layout;
+            }
+
+        mMisses++;
+        }
+
+    // shape without holding the lock, other views may be drawing text
+    sp<SkiWinTextLayout> layout = new SkiWinTextLayout();
+
+    layout->layout(text, len, paint, width, height, spacingMul, spacingAdd);
+
+    Mutex::Autolock _l(mLock);
+
+    size_t bytes = layout->getBytes();
+
+    if (bytes > mBudget || mEntries.indexOfKey(key) >= 0)
+        return layout;
+
+    trim(mBudget - bytes);
+
+    Entry* entry = new Entry;
+    entry->key = key;
+    entry->layout = layout;
+    entry->bytes = bytes;
+
+    pushFront(entry);
+    mEntries.add(key, entry);
+    mUsed += bytes;
+
+    return layout;
+    }
+
+void SkiWinTextLayoutCache::setBudget(size_t budget)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mBudget = budget;
+    trim(mBudget);
+    }
+
+void SkiWinTextLayoutCache::purge()
+    {
+    Mutex::Autolock _l(mLock);
+
+    trim(0);
+    }
+
+void SkiWinTextLayoutCache::dump()
+    {
+    Mutex::Autolock _l(mLock);
+
+    ALOGD("text layout cache: %d entries, %d/%d bytes, hits %u misses %u evictions %u",
+          mEntries.size(), mUsed, mBudget, mHits, mMisses, mEvictions);
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
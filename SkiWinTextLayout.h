@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_TEXT_LAYOUT_H
+#define ANDROID_SKIWIN_TEXT_LAYOUT_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/threads.h>
+#include <utils/KeyedVector.h>
+#include <utils/RefBase.h>
+#include <utils/Vector.h>
+
+#include <SkPaint.h>
+#include <SkPoint.h>
+#include <SkScalar.h>
+
+class SkCanvas;
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * SkiWinTextLayout - Text broken into lines and shaped into glyphs.
+ *
+ * Lines are broken at '\n' and, with a width, at the last space that
+ * still fits, the way SkTextBox does in kLineBreak_Mode. Every line is
+ * counted for the text height, but glyphs and positions are only kept for
+ * the lines starting within the box height, which are all that get drawn.
+ */
+
+class SkiWinTextLayout : public LightRefBase<SkiWinTextLayout>
+    {
+    public:
+        SkiWinTextLayout();
+
+        void layout(const char text[], size_t len, const SkPaint& paint,
+                    SkScalar width, SkScalar height,
+                    SkScalar spacingMul, SkScalar spacingAdd);
+
+        void draw(SkCanvas* canvas, SkScalar x, SkScalar y,
+                  const SkPaint& paint) const;
+
+        size_t getLineCount() const
+            {
+            return mLineCount;
+            }
+        SkScalar getTextHeight() const
+            {
+            return mTextHeight;
+            }
+        SkScalar getBaseline() const
+            {
+            return mBaseline;
+            }
+        size_t getBytes() const;
+
+    private:
+        struct Line
+            {
+            uint32_t start;
+            uint32_t count;
+            };
+
+        // drawn lines, indexing the glyphs and their baseline positions
+        Vector<Line> mLines;
+        Vector<uint16_t> mGlyphs;
+        Vector<SkPoint> mPositions;
+
+        size_t mLineCount;
+        SkScalar mTextHeight;
+
+        // of the first line, below the top of the box
+        SkScalar mBaseline;
+
+        // extent of any glyph above and below its baseline
+        SkScalar mGlyphTop;
+        SkScalar mGlyphBottom;
+    };
+
+/*
+ * SkiWinTextLayoutCache - Layouts keyed on the text, everything in the paint
+ * that changes glyphs or advances, and the box.
+ *
+ * A change to any of them is a different key, so stale layouts are never
+ * returned, they just age out least recently used first once the cache
+ * exceeds its byte budget.
+ */
+
+class SkiWinTextLayoutCache
+    {
+    public:
+        SkiWinTextLayoutCache(size_t budget);
+        ~SkiWinTextLayoutCache();
+
+        sp<SkiWinTextLayout> get(const char text[], size_t len,
+                                 const SkPaint& paint,
+                                 SkScalar width = 0, SkScalar height = 0,
+                                 SkScalar spacingMul = SK_Scalar1,
+                                 SkScalar spacingAdd = 0);
+
+        void setBudget(size_t budget);
+        void purge();
+        void dump();
+
+    private:
+        struct Key
+            {
+            uint64_t hash;
+            size_t len;
+            uint32_t typeface;
+            uint32_t flags;
+            SkScalar textSize;
+            SkScalar textScaleX;
+            SkScalar textSkewX;
+            SkScalar width;
+            SkScalar height;
+            SkScalar spacingMul;
+            SkScalar spacingAdd;
+
+            bool operator<(const Key& rhs) const;
+            };
+
+        struct Entry
+            {
+            Key key;
+            sp<SkiWinTextLayout> layout;
+            size_t bytes;
+            Entry* prev;
+            Entry* next;
+            };
+
+        void unlink(Entry* entry);
+        void pushFront(Entry* entry);
+        void trim(size_t budget);
+
+        Mutex mLock;
+
+        KeyedVector<Key, Entry*> mEntries;
+
+        // most recently used first
+        Entry* mHead;
+        Entry* mTail;
+
+        size_t mBudget;
+        size_t mUsed;
+
+        uint32_t mHits;
+        uint32_t mMisses;
+        uint32_t mEvictions;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_TEXT_LAYOUT_H
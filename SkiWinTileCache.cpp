@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define LOG_TAG "SkiWinTileCache"
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include <core/SkCanvas.h>
+
+#include "SkiWinTileCache.h"
+
+namespace android
+{
+
+static inline uint32_t tileKey(int col, int row)
+    {
+    return (uint32_t(row) << 16) | uint32_t(col);
+    }
+
+SkiWinTileCache::SkiWinTileCache(int tileSize, size_t budget)
+    {
+    mTileSize = tileSize;
+    mWidth = 0;
+    mHeight = 0;
+    mConfig = SkBitmap::kRGB_565_Config;
+    mCallback = NULL;
+    mCallbackContext = NULL;
+    mHead = NULL;
+    mTail = NULL;
+    mBudget = budget;
+    mUsed = 0;
+    mGeneration = 0;
+    mHits = 0;
+    mMisses = 0;
+    mPrefetched = 0;
+    mEvictions = 0;
+    }
+
+SkiWinTileCache::~SkiWinTileCache()
+    {
+    purge();
+    }
+
+/**
+ * setContent - Set what the tiles show, dropping any rendered before.
+ *
+ * Tiles are opaque, the callback has to paint every pixel of its area.
+ */
+
+void SkiWinTileCache::setContent(int width, int height,
+                                 SkBitmap::Config config,
+                                 SkiWinDrawTileCallback callback,
+                                 void* context)
+    {
+    Mutex::Autolock _l(mLock);
+
+    trim(0, false);
+
+    mWidth = width;
+    mHeight = height;
+    mConfig = config;
+    mCallback = callback;
+    mCallbackContext = context;
+    }
+
+/**
+ * invalidate - The content changed, render every tile again.
+ */
+
+void SkiWinTileCache::invalidate()
+    {
+    Mutex::Autolock _l(mLock);
+
+    trim(0, false);
+    }
+
+void SkiWinTileCache::unlink(Tile* tile)
+    {
+    if (tile->prev)
+        tile->prev->next = tile->next;
+    else
+        mHead = tile->next;
+
+    if (tile->next)
+        tile->next->prev = tile->prev;
+    else
+        mTail = tile->prev;
+
+    tile->prev = NULL;
+    tile->next = NULL;
+    }
+
+void SkiWinTileCache::pushFront(Tile* tile)
+    {
+    tile->prev = NULL;
+    tile->next = mHead;
+
+    if (mHead)
+        mHead->prev = tile;
+    else
+        mTail = tile;
+
+    mHead = tile;
+    }
+
+/**
+ * trim - Drop least recently used tiles until they fit budget.
+ *
+ * With keepShown, tiles drawn by the last draw() stay even if that leaves
+ * the cache over budget.
+ */
+
+void SkiWinTileCache::trim(size_t budget, bool keepShown)
+    {
+    Tile* tile = mTail;
+
+    while (tile && mUsed > budget)
+        {
+        Tile* victim = tile;
+
+        tile = tile->prev;
+
+        if (keepShown && victim->generation == mGeneration)
+            continue;
+
+        unlink(victim);
+        mTiles.removeItem(victim->key);
+        mUsed -= victim->bitmap.getSize();
+        mEvictions++;
+
+        delete victim;
+        }
+    }
+
+/**
+ * renderTileLocked - Render the tile at col, row and add it to the cache.
+ *
+ * Tiles are rendered holding the lock, by whichever thread calls draw()
+ * or prefetch(), so the callback never runs twice at once. Returns NULL
+ * if the tile has no pixels.
+ */
+
+SkiWinTileCache::Tile* SkiWinTileCache::renderTileLocked(int col, int row)
+    {
+    SkIRect area = SkIRect::MakeXYWH(col * mTileSize, row * mTileSize,
+                                     mTileSize, mTileSize);
+
+    if (mCallback == NULL || !area.intersect(0, 0, mWidth, mHeight))
+        return NULL;
+
+    Tile* tile = new Tile;
+
+    tile->key = tileKey(col, row);
+    tile->generation = 0;
+    tile->bitmap.setConfig(mConfig, area.width(), area.height());
+    tile->bitmap.setIsOpaque(true);
+
+    size_t bytes = tile->bitmap.getSize();
+
+    trim(bytes < mBudget ? mBudget - bytes : 0, true);
+
+    if (!tile->bitmap.allocPixels())
+        {
+        delete tile;
+        return NULL;
+        }
+
+    SkCanvas canvas(tile->bitmap);
+
+    mCallback(mCallbackContext, &canvas, area);
+
+    pushFront(tile);
+    mTiles.add(tile->key, tile);
+    mUsed += bytes;
+
+    return tile;
+    }
+
+SkiWinTileCache::Tile* SkiWinTileCache::getTileLocked(int col, int row)
+    {
+    ssize_t index = mTiles.indexOfKey(tileKey(col, row));
+
+    if (index >= 0)
+        {
+        Tile* tile = mTiles.valueAt(index);
+
+        unlink(tile);
+        pushFront(tile);
+        mHits++;
+
+        return tile;
+        }
+
+    mMisses++;
+
+    return renderTileLocked(col, row);
+    }
+
+/**
+ * draw - Blit the content in area with its top left at x, y.
+ *
+ * Tiles not rendered yet are rendered first, all tiles drawn are kept
+ * until the next draw().
+ */
+
+void SkiWinTileCache::draw(SkCanvas* canvas, const SkIRect& area, int x, int y)
+    {
+    Mutex::Autolock _l(mLock);
+    SkIRect r(area);
+
+    mGeneration++;
+
+    if (!r.intersect(0, 0, mWidth, mHeight))
+        return;
+
+    int colStart = r.fLeft / mTileSize;
+    int colEnd = (r.fRight - 1) / mTileSize;
+    int rowStart = r.fTop / mTileSize;
+    int rowEnd = (r.fBottom - 1) / mTileSize;
+
+    for (int row = rowStart; row <= rowEnd; row++)
+        {
+        for (int col = colStart; col <= colEnd; col++)
+            {
+            Tile* tile = getTileLocked(col, row);
+
+            if (tile == NULL)
+                continue;
+
+            tile->generation = mGeneration;
+
+            canvas->drawBitmap(tile->bitmap,
+                               SkIntToScalar(x + col * mTileSize - area.fLeft),
+                               SkIntToScalar(y + row * mTileSize - area.fTop));
+            }
+        }
+    }
+
+/**
+ * prefetchRowLocked - Render the missing tiles of a row, at most count.
+ *
+ * Returns the number of tiles rendered, or -1 once the budget is full of
+ * tiles that are shown.
+ */
+
+int SkiWinTileCache::prefetchRowLocked(int row, int colStart, int colEnd,
+                                       int count)
+    {
+    int rendered = 0;
+
+    if (row < 0 || row * mTileSize >= mHeight)
+        return 0;
+
+    for (int col = colStart; col <= colEnd && rendered < count; col++)
+        {
+        if (mTiles.indexOfKey(tileKey(col, row)) >= 0)
+            continue;
+
+        SkIRect area = SkIRect::MakeXYWH(col * mTileSize, row * mTileSize,
+                                         mTileSize, mTileSize);
+
+        if (!area.intersect(0, 0, mWidth, mHeight))
+            continue;
+
+        size_t bytes = area.width() * area.height() *
+                       SkBitmap::ComputeBytesPerPixel(mConfig);
+
+        trim(bytes < mBudget ? mBudget - bytes : 0, true);
+
+        if (mUsed + bytes > mBudget || renderTileLocked(col, row) == NULL)
+            return -1;
+
+        mPrefetched++;
+        rendered++;
+        }
+
+    return rendered;
+    }
+
+/**
+ * prefetch - Render up to count tiles about to scroll into viewport.
+ *
+ * Looks a viewport height ahead in direction, 1 towards the end of the
+ * content and -1 towards its start, nearest rows first. A direction of
+ * 0 looks both ways. Nothing shown is evicted for a prefetched tile.
+ * Returns the number of tiles rendered.
+ */
+
+int SkiWinTileCache::prefetch(const SkIRect& viewport, int direction,
+                              int count)
+    {
+    Mutex::Autolock _l(mLock);
+    int rendered = 0;
+
+    if (mCallback == NULL || viewport.isEmpty())
+        return 0;
+
+    int colStart = viewport.fLeft / mTileSize;
+    int colEnd = (viewport.fRight - 1) / mTileSize;
+    int below = (viewport.fBottom - 1) / mTileSize + 1;
+    int above = viewport.fTop / mTileSize - 1;
+    int rows = (viewport.height() + mTileSize - 1) / mTileSize;
+
+    for (int i = 0; i < rows && rendered < count; i++)
+        {
+        int n;
+
+        if (direction >= 0)
+            {
+            n = prefetchRowLocked(below + i, colStart, colEnd,
+                                  count - rendered);
+            if (n < 0)
+                break;
+            rendered += n;
+            }
+
+        if (direction <= 0 && rendered < count)
+            {
+            n = prefetchRowLocked(above - i, colStart, colEnd,
+                                  count - rendered);
+            if (n < 0)
+                break;
+            rendered += n;
+            }
+        }
+
+    return rendered;
+    }
+
+void SkiWinTileCache::setBudget(size_t budget)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mBudget = budget;
+    trim(mBudget, true);
+    }
+
+void SkiWinTileCache::purge()
+    {
+    Mutex::Autolock _l(mLock);
+
+    trim(0, false);
+    }
+
+void SkiWinTileCache::dump()
+    {
+    Mutex::Autolock _l(mLock);
+
+    ALOGD("tile cache: %d tiles, %d/%d bytes, hits %u misses %u prefetched %u evictions %u",
+          mTiles.size(), mUsed, mBudget, mHits, mMisses, mPrefetched,
+          mEvictions);
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_SKIWIN_TILE_CACHE_H
+#define ANDROID_SKIWIN_TILE_CACHE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/threads.h>
+#include <utils/KeyedVector.h>
+
+#include <SkBitmap.h>
+#include <SkRect.h>
+
+class SkCanvas;
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+// draws the part of the content in area, the canvas origin at its top left
+typedef void (*SkiWinDrawTileCallback)(void* context, SkCanvas* canvas,
+                                       const SkIRect& area);
+
+/*
+ * SkiWinTileCache - Content too large for a view, kept as raster tiles.
+ *
+ * The content is split into a grid of square tiles, each rendered by the
+ * callback the first time it is drawn and blitted from then on. Tiles are
+ * dropped least recently used first once they exceed the byte budget, but
+ * never those drawn by the last call to draw(), which are on screen.
+ *
+ * prefetch() renders tiles just outside the view ahead of a scroll, a few
+ * at a time, so scrolling mostly finds them ready.
+ *
+ * Every call takes the cache lock and may be made from any thread, draw()
+ * runs on a frame executor worker, prefetch() on the SkiWin thread. The
+ * callback is called with the lock held, one tile at a time.
+ */
+
+class SkiWinTileCache
+    {
+    public:
+        SkiWinTileCache(int tileSize, size_t budget);
+        ~SkiWinTileCache();
+
+        void setContent(int width, int height, SkBitmap::Config config,
+                        SkiWinDrawTileCallback callback, void* context);
+        void invalidate();
+
+        void draw(SkCanvas* canvas, const SkIRect& area, int x, int y);
+        int prefetch(const SkIRect& viewport, int direction, int count);
+
+        void setBudget(size_t budget);
+        void purge();
+        void dump();
+
+    private:
+        struct Tile
+            {
+            uint32_t key;
+            SkBitmap bitmap;
+            uint32_t generation;
+            Tile* prev;
+            Tile* next;
+            };
+
+        Tile* getTileLocked(int col, int row);
+        Tile* renderTileLocked(int col, int row);
+        int prefetchRowLocked(int row, int colStart, int colEnd, int count);
+        void unlink(Tile* tile);
+        void pushFront(Tile* tile);
+        void trim(size_t budget, bool keepShown);
+
+        int mTileSize;
+
+        Mutex mLock;
+
+        int mWidth;
+        int mHeight;
+        SkBitmap::Config mConfig;
+        SkiWinDrawTileCallback mCallback;
+        void* mCallbackContext;
+
+        // keyed on row << 16 | column
+        KeyedVector<uint32_t, Tile*> mTiles;
+
+        // most recently used first
+        Tile* mHead;
+        Tile* mTail;
+
+        size_t mBudget;
+        size_t mUsed;
+
+        // counts calls to draw(), tiles drawn by the last one are shown
+        uint32_t mGeneration;
+
+        uint32_t mHits;
+        uint32_t mMisses;
+        uint32_t mPrefetched;
+        uint32_t mEvictions;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_TILE_CACHE_H
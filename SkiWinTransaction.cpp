@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinTransaction"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include "SkiWinSurfacePool.h"
+#include "SkiWinTransaction.h"
+#include "SkiWinView.h"
+#include "SkiWinWindowManager.h"
+
+namespace android
+{
+
+SkiWinTransaction::SkiWinTransaction(const sp<SkiWinSurfaceBackend>& backend) :
+    mBackend(backend)
+    {
+    }
+
+SkiWinTransaction::~SkiWinTransaction()
+    {
+    }
+
+SkiWinTransaction::Change& SkiWinTransaction::editChange(
+    const sp<SkiWinView>& view)
+    {
+    for (size_t i = 0; i < mChanges.size(); i++)
+        {
+        if (mChanges[i].view == view)
+            return mChanges.editItemAt(i);
+        }
+
+    Change change;
+
+    change.view = view;
+    change.what = 0;
+    change.visible = false;
+    change.x = 0;
+    change.y = 0;
+    change.layer = 0;
+    change.w = 0;
+    change.h = 0;
+    change.alpha = 1.0f;
+    change.matrix[0] = 1.0f;
+    change.matrix[1] = 0.0f;
+    change.matrix[2] = 0.0f;
+    change.matrix[3] = 1.0f;
+
+    return mChanges.editItemAt(mChanges.add(change));
+    }
+
+SkiWinTransaction& SkiWinTransaction::setVisible(const sp<SkiWinView>& view,
+                                                 bool visible)
+    {
+    Change& change = editChange(view);
+
+    change.what |= CHANGE_VISIBLE;
+    change.visible = visible;
+
+    return *this;
+    }
+
+SkiWinTransaction& SkiWinTransaction::setPosition(const sp<SkiWinView>& view,
+                                                  int x, int y)
+    {
+    Change& change = editChange(view);
+
+    change.what |= CHANGE_POSITION;
+    change.x = x;
+    change.y = y;
+
+    return *this;
+    }
+
+SkiWinTransaction& SkiWinTransaction::setLayer(const sp<SkiWinView>& view,
+                                               int32_t layer)
+    {
+    Change& change = editChange(view);
+
+    change.what |= CHANGE_LAYER;
+    change.layer = layer;
+
+    return *this;
+    }
+
+SkiWinTransaction& SkiWinTransaction::setSize(const sp<SkiWinView>& view,
+                                              int w, int h)
+    {
+    Change& change = editChange(view);
+
+    change.what |= CHANGE_SIZE;
+    change.w = w;
+    change.h = h;
+
+    return *this;
+    }
+
+SkiWinTransaction& SkiWinTransaction::setAlpha(const sp<SkiWinView>& view,
+                                               float alpha)
+    {
+    Change& change = editChange(view);
+
+    change.what |= CHANGE_ALPHA;
+    change.alpha = alpha;
+
+    return *this;
+    }
+
+/**
+ * setMatrix - Transform the surface as SurfaceFlinger composes it.
+ *
+ * Nothing is redrawn, hit testing and damage stay in untransformed view
+ * space.
+ */
+
+SkiWinTransaction& SkiWinTransaction::setMatrix(const sp<SkiWinView>& view,
+                                                float dsdx, float dtdx,
+                                                float dsdy, float dtdy)
+    {
+    Change& change = editChange(view);
+
+    change.what |= CHANGE_MATRIX;
+    change.matrix[0] = dsdx;
+    change.matrix[1] = dtdx;
+    change.matrix[2] = dsdy;
+    change.matrix[3] = dtdy;
+
+    return *this;
+    }
+
+/**
+ * apply - Commit the staged changes in one backend transaction.
+ *
+ * The views take on their new geometry at the same time, so hit testing
+ * and drawing agree with what is shown, and their window manager
+ * reindexes them once it is committed. The transaction is empty again
+ * afterwards and can be reused.
+ */
+
+status_t SkiWinTransaction::apply()
+    {
+    status_t result = NO_ERROR;
+
+    if (mChanges.isEmpty())
+        return NO_ERROR;
+
+    mBackend->openTransaction();
+
+    for (size_t i = 0; i < mChanges.size(); i++)
+        {
+        const Change& change = mChanges[i];
+        const sp<SkiWinSurface>& surface = change.view->mSurface;
+        status_t err = NO_ERROR;
+
+        if (surface == NULL)
+            continue;
+
+        if (change.what & CHANGE_LAYER)
+            {
+            err = surface->setLayer(change.layer);
+            change.view->mLayer = change.layer;
+            }
+
+        if (change.what & CHANGE_POSITION)
+            {
+            err = surface->setPosition(change.x, change.y);
+            change.view->mLeft = change.x;
+            change.view->mTop = change.y;
+            }
+
+        if (change.what & CHANGE_SIZE)
+            {
+            const sp<SkiWinView>& view = change.view;
+
+            // growing past the buffer reallocates it, anything else is
+            // only a different crop of the buffers already there
+            if (change.w > view->mBufferWidth ||
+                change.h > view->mBufferHeight)
+                {
+                int bw = SkiWinSurfacePool::bucketSize(change.w);
+                int bh = SkiWinSurfacePool::bucketSize(change.h);
+
+                if (bw < view->mBufferWidth)
+                    bw = view->mBufferWidth;
+                if (bh < view->mBufferHeight)
+                    bh = view->mBufferHeight;
+
+                err = surface->setSize(bw, bh);
+                view->mBufferWidth = bw;
+                view->mBufferHeight = bh;
+                }
+
+            if (err == NO_ERROR)
+                err = surface->setCrop(Rect(change.w, change.h));
+
+            view->resized(change.w, change.h);
+            }
+
+        if (change.what & CHANGE_ALPHA)
+            {
+            err = surface->setAlpha(change.alpha);
+            change.view->mAlpha = change.alpha;
+            }
+
+        if (change.what & CHANGE_MATRIX)
+            {
+            err = surface->setMatrix(change.matrix[0], change.matrix[1],
+                                     change.matrix[2], change.matrix[3]);
+            memcpy(change.view->mMatrix, change.matrix,
+                   sizeof(change.view->mMatrix));
+            }
+
+        if (change.what & CHANGE_VISIBLE)
+            {
+            // a flattened view is shown by the flattening compositor, its
+            // own surface may only still be up if it is to be hidden
+            if (!change.view->mFlattened)
+                {
+                err = change.visible ? surface->show() : surface->hide();
+                }
+            else if (!change.visible && change.view->mHidePending)
+                {
+                err = surface->hide();
+                change.view->mHidePending = false;
+                }
+
+            change.view->mVisible = change.visible;
+            change.view->mShowPending = false;
+            }
+
+        if (err != NO_ERROR)
+            {
+            ALOGW("transaction change 0x%x failed (%d)", change.what, err);
+            result = err;
+            }
+        }
+
+    mBackend->closeTransaction();
+
+    // keep the hit testing of the window managers up to date
+    for (size_t i = 0; i < mChanges.size(); i++)
+        {
+        const Change& change = mChanges[i];
+
+        if (!(change.what & (CHANGE_VISIBLE | CHANGE_POSITION |
+                             CHANGE_LAYER | CHANGE_SIZE)))
+            continue;
+
+        sp<SkiWinWindowManager> wm = change.view->mWindowManager.promote();
+
+        if (wm != NULL)
+            wm->windowChanged(change.view, change.what & CHANGE_LAYER);
+        }
+
+    mChanges.clear();
+
+    return result;
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
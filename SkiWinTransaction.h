@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_TRANSACTION_H
+#define ANDROID_SKIWIN_TRANSACTION_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/RefBase.h>
+#include <utils/Vector.h>
+
+#include "SkiWinSurfaceBackend.h"
+
+namespace android
+{
+
+class SkiWinView;
+
+// ---------------------------------------------------------------------------
+
+/*
+ * SkiWinTransaction - View property changes staged and committed together.
+ *
+ * Changes to any number of views are collected, a later change to the same
+ * property of a view replacing the earlier one, and apply() sends all of
+ * them in a single backend transaction, which is one round trip to
+ * SurfaceFlinger. Nothing is shown half updated, and nothing happens if the
+ * transaction is dropped without apply().
+ */
+
+class SkiWinTransaction
+    {
+    public:
+        SkiWinTransaction(const sp<SkiWinSurfaceBackend>& backend);
+        ~SkiWinTransaction();
+
+        SkiWinTransaction& setVisible(const sp<SkiWinView>& view,
+                                      bool visible);
+        SkiWinTransaction& setPosition(const sp<SkiWinView>& view,
+                                       int x, int y);
+        SkiWinTransaction& setLayer(const sp<SkiWinView>& view,
+                                    int32_t layer);
+        SkiWinTransaction& setSize(const sp<SkiWinView>& view, int w, int h);
+        SkiWinTransaction& setAlpha(const sp<SkiWinView>& view, float alpha);
+        SkiWinTransaction& setMatrix(const sp<SkiWinView>& view,
+                                     float dsdx, float dtdx,
+                                     float dsdy, float dtdy);
+
+        bool isEmpty() const
+            {
+            return mChanges.isEmpty();
+            }
+
+        status_t apply();
+
+    private:
+        enum
+            {
+            CHANGE_VISIBLE  = 0x01,
+            CHANGE_POSITION = 0x02,
+            CHANGE_LAYER    = 0x04,
+            CHANGE_SIZE     = 0x08,
+            CHANGE_ALPHA    = 0x10,
+            CHANGE_MATRIX   = 0x20
+            };
+
+        struct Change
+            {
+            sp<SkiWinView> view;
+            uint32_t what;
+            bool visible;
+            int x;
+            int y;
+            int32_t layer;
+            int w;
+            int h;
+            float alpha;
+            float matrix[4];
+            };
+
+        Change& editChange(const sp<SkiWinView>& view);
+
+        sp<SkiWinSurfaceBackend> mBackend;
+        Vector<Change> mChanges;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_TRANSACTION_H
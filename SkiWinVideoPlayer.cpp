@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SkiWinVideoPlayer"
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <utils/Log.h>
+
+#include <core/SkBitmap.h>
+#include <images/SkImageDecoder.h>
+
+#include "SkiWinVideoPlayer.h"
+
+// how long the reader backs off when there is no frame 0 to play
+#define NO_VIDEO_RETRY_INTERVAL ms2ns(1000)
+
+namespace android
+{
+
+SkiWinVideoPlayer::SkiWinVideoPlayer(const char* pattern, int workers,
+                                     int depth, nsecs_t frameInterval) :
+    mPattern(pattern), mFrameInterval(frameInterval), mWorkers(workers)
+    {
+    Slot empty;
+
+    empty.seq = 0;
+    empty.state = SLOT_EMPTY;
+    empty.dropped = false;
+    empty.data = NULL;
+    empty.size = 0;
+
+    mSlots.insertAt(empty, 0, depth > 0 ? depth : 1);
+
+    mStopping = false;
+    mFileIndex = 0;
+    mReadSeq = 0;
+    mDecodeSeq = 0;
+    mPresentSeq = 0;
+    mStartTime = 0;
+    mStartSeq = 0;
+    mDropped = 0;
+    mLoops = 0;
+    mCallback = NULL;
+    mCallbackContext = NULL;
+    }
+
+SkiWinVideoPlayer::~SkiWinVideoPlayer()
+    {
+    stop();
+    }
+
+void SkiWinVideoPlayer::setFrameReadyCallback(FrameReadyCallback callback,
+                                              void* context)
+    {
+    Mutex::Autolock _l(mLock);
+
+    mCallback = callback;
+    mCallbackContext = context;
+    }
+
+status_t SkiWinVideoPlayer::start()
+    {
+    mReader = new ReaderThread(this);
+
+    status_t err = mReader->run("SkiWinVideoReader", PRIORITY_BACKGROUND);
+    if (err != NO_ERROR)
+        return err;
+
+    for (int i = 0; i < mWorkers; i++)
+        {
+        sp<DecoderThread> decoder = new DecoderThread(this);
+
+        err = decoder->run("SkiWinVideoDecoder", PRIORITY_BACKGROUND);
+        if (err != NO_ERROR)
+            break;
+
+        mDecoders.add(decoder);
+        }
+
+    return err;
+    }
+
+void SkiWinVideoPlayer::stop()
+    {
+        {
+        Mutex::Autolock _l(mLock);
+
+        mStopping = true;
+        mSlotFree.broadcast();
+        mWorkAvailable.broadcast();
+        }
+
+    if (mReader != NULL)
+        {
+        mReader->requestExitAndWait();
+        mReader = NULL;
+        }
+
+    for (size_t i = 0; i < mDecoders.size(); i++)
+        mDecoders[i]->requestExitAndWait();
+
+    mDecoders.clear();
+
+    for (size_t i = 0; i < mSlots.size(); i++)
+        releaseSlot(mSlots.editItemAt(i));
+    }
+
+SkiWinVideoPlayer::Slot& SkiWinVideoPlayer::slotFor(uint32_t seq)
+    {
+    return mSlots.editItemAt(seq % mSlots.size());
+    }
+
+void SkiWinVideoPlayer::releaseSlot(Slot& slot)
+    {
+    free(slot.data);
+
+    slot.data = NULL;
+    slot.size = 0;
+    slot.bitmap.reset();
+    slot.dropped = false;
+    slot.state = SLOT_EMPTY;
+    }
+
+char* SkiWinVideoPlayer::readFile(int index, size_t* size)
+    {
+    String8 name = String8::format(mPattern.string(), index);
+    struct stat st;
+    char* data;
+
+    int fd = open(name.string(), O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) < 0 || st.st_size <= 0)
+        {
+        close(fd);
+        return NULL;
+        }
+
+    data = (char*)malloc(st.st_size);
+    if (data == NULL)
+        {
+        close(fd);
+        return NULL;
+        }
+
+    if (read(fd, data, st.st_size) != st.st_size)
+        {
+        ALOGW("short read of '%s': %s", name.string(), strerror(errno));
+
+        free(data);
+        close(fd);
+        return NULL;
+        }
+
+    close(fd);
+
+    *size = st.st_size;
+    return data;
+    }
+
+/**
+ * readOne - Reader stage, load the next file into a free ring slot.
+ *
+ * Blocks while the ring is full, which is what keeps the reader from
+ * running ahead of playback.
+ */
+
+bool SkiWinVideoPlayer::readOne()
+    {
+    int index;
+
+        {
+        Mutex::Autolock _l(mLock);
+
+        while (!mStopping && slotFor(mReadSeq).state != SLOT_EMPTY)
+            mSlotFree.wait(mLock);
+
+        if (mStopping)
+            return false;
+
+        index = mFileIndex;
+        }
+
+    size_t size = 0;
+    char* data = readFile(index, &size);
+
+    if (data == NULL)
+        {
+        Mutex::Autolock _l(mLock);
+
+        if (index == 0)
+            {
+            // nothing to play at all, check again later
+            mSlotFree.waitRelative(mLock, NO_VIDEO_RETRY_INTERVAL);
+            }
+        else
+            {
+            // ran off the end of the sequence, loop back to the start
+            mFileIndex = 0;
+            mLoops++;
+            }
+
+        return !mStopping;
+        }
+
+    Mutex::Autolock _l(mLock);
+
+    Slot& slot = slotFor(mReadSeq);
+
+    slot.seq = mReadSeq;
+    slot.data = data;
+    slot.size = size;
+    slot.dropped = false;
+    slot.state = SLOT_LOADED;
+
+    mReadSeq++;
+    mFileIndex++;
+
+    mWorkAvailable.signal();
+
+    return true;
+    }
+
+/**
+ * decodeOne - Decoder stage, turn the oldest loaded slot into a bitmap.
+ *
+ * Several decoders run concurrently, each one owns the slot it took until
+ * it is marked ready, so frames may complete out of order.
+ */
+
+bool SkiWinVideoPlayer::decodeOne()
+    {
+    uint32_t seq;
+    char* data;
+    size_t size;
+
+        {
+        Mutex::Autolock _l(mLock);
+
+        while (!mStopping && mDecodeSeq == mReadSeq)
+            mWorkAvailable.wait(mLock);
+
+        if (mStopping)
+            return false;
+
+        seq = mDecodeSeq++;
+
+        Slot& slot = slotFor(seq);
+
+        if (slot.dropped)
+            {
+            // already late, do not bother decoding it
+            releaseSlot(slot);
+            mSlotFree.signal();
+            return true;
+            }
+
+        slot.state = SLOT_DECODING;
+        data = slot.data;
+        size = slot.size;
+        }
+
+    SkBitmap bitmap;
+
+    SkImageDecoder::DecodeMemory(data, size, &bitmap);
+
+    FrameReadyCallback callback = NULL;
+    void* context = NULL;
+
+        {
+        Mutex::Autolock _l(mLock);
+
+        Slot& slot = slotFor(seq);
+
+        if (slot.dropped || !bitmap.pixelRef())
+            {
+            releaseSlot(slot);
+            mSlotFree.signal();
+            return true;
+            }
+
+        free(slot.data);
+        slot.data = NULL;
+        slot.size = 0;
+        slot.bitmap = bitmap;
+        slot.state = SLOT_READY;
+
+        callback = mCallback;
+        context = mCallbackContext;
+        }
+
+    if (callback)
+        callback(context);
+
+    return true;
+    }
+
+bool SkiWinVideoPlayer::ReaderThread::threadLoop()
+    {
+    return mPlayer->readOne();
+    }
+
+bool SkiWinVideoPlayer::DecoderThread::threadLoop()
+    {
+    return mPlayer->decodeOne();
+    }
+
+/**
+ * getNextFrameTime - Presentation time of the next frame.
+ *
+ * Returns 0 before the first frame was shown, meaning "as soon as ready".
+ */
+
+nsecs_t SkiWinVideoPlayer::getNextFrameTime()
+    {
+    Mutex::Autolock _l(mLock);
+
+    if (mStartTime == 0)
+        return 0;
+
+    return mStartTime + nsecs_t(mPresentSeq - mStartSeq) * mFrameInterval;
+    }
+
+/**
+ * acquireFrame - Take the frame due at the given time, if it is ready.
+ *
+ * Frames whose slot has already passed are dropped, whether they were
+ * decoded in time or not. Returns false if the frame that is due is still
+ * being read or decoded, the frame ready callback fires once it is.
+ */
+
+bool SkiWinVideoPlayer::acquireFrame(nsecs_t now, SkBitmap* bitmap)
+    {
+    Mutex::Autolock _l(mLock);
+
+    if (mStartTime != 0)
+        {
+        uint32_t due = mStartSeq + uint32_t((now - mStartTime) / mFrameInterval);
+
+        while (mPresentSeq < due && mPresentSeq < mReadSeq)
+            {
+            Slot& slot = slotFor(mPresentSeq);
+
+            if (slot.seq == mPresentSeq && slot.state != SLOT_EMPTY)
+                {
+                if (slot.state == SLOT_READY)
+                    releaseSlot(slot);
+                else
+                    {
+                    // still waiting for or owned by a decoder, which
+                    // releases the slot when it gets to it
+                    slot.dropped = true;
+                    }
+                }
+
+            mDropped++;
+            mPresentSeq++;
+            }
+
+        mSlotFree.signal();
+        }
+
+    // skip frames that failed to decode, their slot is already recycled
+    while (mPresentSeq < mReadSeq)
+        {
+        Slot& slot = slotFor(mPresentSeq);
+
+        if (slot.seq == mPresentSeq && slot.state != SLOT_EMPTY)
+            break;
+
+        mDropped++;
+        mPresentSeq++;
+        }
+
+    if (mPresentSeq == mReadSeq)
+        return false;
+
+    Slot& slot = slotFor(mPresentSeq);
+
+    if (slot.state != SLOT_READY)
+        return false;
+
+    *bitmap = slot.bitmap;
+
+    releaseSlot(slot);
+    mSlotFree.signal();
+
+    if (mStartTime == 0)
+        {
+        mStartTime = now;
+        mStartSeq = mPresentSeq;
+        }
+
+    mPresentSeq++;
+
+    return true;
+    }
+
+uint32_t SkiWinVideoPlayer::getDroppedFrames()
+    {
+    Mutex::Autolock _l(mLock);
+
+    return mDropped;
+    }
+
+uint32_t SkiWinVideoPlayer::getLoops()
+    {
+    Mutex::Autolock _l(mLock);
+
+    return mLoops;
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
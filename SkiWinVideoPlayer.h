@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SKIWIN_VIDEO_PLAYER_H
+#define ANDROID_SKIWIN_VIDEO_PLAYER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/String8.h>
+#include <utils/threads.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+#include <SkBitmap.h>
+
+#include "SkiWinFrameSource.h"
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * SkiWinVideoPlayer - Prefetching playback of a numbered image sequence.
+ *
+ * A reader thread loads screen-0, screen-1, ... into a bounded ring, a pool
+ * of decoder threads turns them into bitmaps, and the compositor picks the
+ * frame that is due with acquireFrame(). The reader stalls while the ring
+ * is full, wraps around to frame 0 when the next file is missing, and
+ * frames whose presentation time has passed before they could be shown are
+ * dropped and counted.
+ */
+
+class SkiWinVideoPlayer : public SkiWinFrameSource
+    {
+    public:
+        SkiWinVideoPlayer(const char* pattern, int workers, int depth,
+                          nsecs_t frameInterval);
+        virtual ~SkiWinVideoPlayer();
+
+        virtual void setFrameReadyCallback(FrameReadyCallback callback,
+                                           void* context);
+
+        virtual status_t start();
+        virtual void stop();
+
+        virtual nsecs_t getNextFrameTime();
+        virtual bool acquireFrame(nsecs_t now, SkBitmap* bitmap);
+
+        virtual uint32_t getDroppedFrames();
+        virtual uint32_t getLoops();
+
+    private:
+        enum SlotState
+            {
+            SLOT_EMPTY,
+            SLOT_LOADED,
+            SLOT_DECODING,
+            SLOT_READY
+            };
+
+        struct Slot
+            {
+            uint32_t seq;
+            SlotState state;
+            bool dropped;
+            char* data;
+            size_t size;
+            SkBitmap bitmap;
+            };
+
+        class ReaderThread : public Thread
+            {
+            public:
+                ReaderThread(SkiWinVideoPlayer* player) : mPlayer(player) {}
+            private:
+                virtual bool threadLoop();
+                SkiWinVideoPlayer* mPlayer;
+            };
+
+        class DecoderThread : public Thread
+            {
+            public:
+                DecoderThread(SkiWinVideoPlayer* player) : mPlayer(player) {}
+            private:
+                virtual bool threadLoop();
+                SkiWinVideoPlayer* mPlayer;
+            };
+
+        bool readOne();
+        bool decodeOne();
+
+        char* readFile(int index, size_t* size);
+        Slot& slotFor(uint32_t seq);
+        void releaseSlot(Slot& slot);
+
+        String8 mPattern;
+        nsecs_t mFrameInterval;
+        int mWorkers;
+
+        Mutex mLock;
+        Condition mSlotFree;
+        Condition mWorkAvailable;
+        bool mStopping;
+
+        Vector<Slot> mSlots;
+
+        // next file the reader loads
+        int mFileIndex;
+
+        // sequence numbers keep counting across loops of the file sequence
+        uint32_t mReadSeq;
+        uint32_t mDecodeSeq;
+        uint32_t mPresentSeq;
+
+        // playback clock, started when the first frame is shown
+        nsecs_t mStartTime;
+        uint32_t mStartSeq;
+
+        uint32_t mDropped;
+        uint32_t mLoops;
+
+        FrameReadyCallback mCallback;
+        void* mCallbackContext;
+
+        sp<ReaderThread> mReader;
+        Vector< sp<DecoderThread> > mDecoders;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_VIDEO_PLAYER_H
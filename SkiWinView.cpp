@@ -17,6 +17,8 @@
 #define LOG_TAG "SkiWinView"
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <math.h>
 #include <fcntl.h>
@@ -39,10 +41,6 @@
 #include <ui/DisplayInfo.h>
 #include <ui/FramebufferNativeWindow.h>
 
-#include <gui/ISurfaceComposer.h>
-#include <gui/Surface.h>
-#include <gui/SurfaceComposerClient.h>
-
 #include <input/InputWindow.h>
 #include <input/InputReader.h>
 
@@ -54,57 +52,199 @@
 #include <GLES/glext.h>
 #include <EGL/eglext.h>
 
+#include "SkiWinFrameStats.h"
+#include "SkiWinTransaction.h"
 #include "SkiWinView.h"
+#include "SkiWinPixelConvert.h"
+
+// buffers of a surface whose scroll position is remembered, a surface
+// never cycles through more
+#define MAX_SCROLL_BUFFERS      4
 
 namespace android
 {
 
-SkiWinView::SkiWinView(sp<SurfaceComposerClient> & client, 
+/**
+ * SkiWinView - Show a window on a surface handed out by SkiWinSurfacePool.
+ *
+ * The surface may be larger than the view, bufferWidth x bufferHeight, and
+ * is cropped to it. It stays hidden until the first frame is posted.
+ */
+
+SkiWinView::SkiWinView(const sp<SkiWinSurfaceBackend> & backend, 
+                       const sp<SkiWinSurface> & surface,
+                       int bufferWidth, int bufferHeight,
                        const String8 & name,
-                       int x, int y, int w, int h, int l) : 
-                       mSurfaceComposerClient(client),
-                       mLeft(x), mTop(y), mWidth(w), mHeight(h), mLayer(l)
-    {
-    mSurfaceControl = mSurfaceComposerClient->createSurface(name,
-                                 w, h, PIXEL_FORMAT_RGB_565);
-    
-    SurfaceComposerClient::openGlobalTransaction();
-    mSurfaceControl->setLayer(mLayer);
-    mSurfaceControl->setPosition(x, y);
-    mSurfaceControl->show();
-    SurfaceComposerClient::closeGlobalTransaction();
-    
-    mSurface = mSurfaceControl->getSurface();
+                       int x, int y, int w, int h, int l,
+                       PixelFormat format) : 
+                       mBackend(backend), mSurface(surface),
+                       mLeft(x), mTop(y), mWidth(w), mHeight(h), mLayer(l),
+                       mFormat(format),
+                       mBufferWidth(bufferWidth), mBufferHeight(bufferHeight)
+    {
+    mBackend->openTransaction();
+    mSurface->setLayer(mLayer);
+    mSurface->setPosition(x, y);
+    mSurface->setCrop(Rect(w, h));
+    mSurface->setAlpha(1.0f);
+    // a pooled surface may come from a window closed while scaled
+    mSurface->setMatrix(1.0f, 0.0f, 0.0f, 1.0f);
+    mBackend->closeTransaction();
+
+    mVisible = false;
+    mAlpha = 1.0f;
+    mMatrix[0] = 1.0f;
+    mMatrix[1] = 0.0f;
+    mMatrix[2] = 0.0f;
+    mMatrix[3] = 1.0f;
+    mShowPending = true;
+    mFlattened = false;
+    mHidePending = false;
+    mOriginX = 0;
+    mOriginY = 0;
+
+    mWindowOrder = 0;
 
     mContext = NULL;
+    mFocusable = false;
+    mContentLeft = 0;
+    mContentTop = 0;
+    mDirectRendering = false;
+    mOpaque = false;
+    mDither = false;
+
+    mStatsRow = SkiWinFrameStats::get()->addRow(name.string());
+
+    mScrollActive = false;
+    mScrollX = 0;
+    mScrollY = 0;
+    mScrollGeneration = 0;
+    mFrameScrollActive = false;
+    mFrameScrollX = 0;
+    mFrameScrollY = 0;
+    mFrameScrollGeneration = 0;
+    mScrollBuffersGeneration = 0;
+    mScrollBufferLocked = -1;
+
+    // nothing has been posted yet, so the whole view needs a first frame
+    mDamage.setRect(0, 0, mWidth, mHeight);
     }
 
 SkiWinView::~SkiWinView()
     {
-    mSurfaceComposerClient = NULL;
-    mSurfaceControl = NULL;
     mSurface = NULL;
+    mBackend = NULL;
     }
 
 void SkiWinView::clear()
     {
-    SurfaceComposerClient::openGlobalTransaction();
-    mSurfaceControl->clear();
-    SurfaceComposerClient::closeGlobalTransaction();
+    mBackend->openTransaction();
+    mSurface->clear();
+    mBackend->closeTransaction();
     }
 
+/**
+ * hide - Hide just this view, SkiWinTransaction batches several views.
+ */
+
 void SkiWinView::hide()
     {
-    SurfaceComposerClient::openGlobalTransaction();
-    mSurfaceControl->hide();
-    SurfaceComposerClient::closeGlobalTransaction();
+    SkiWinTransaction t(mBackend);
+
+    t.setVisible(this, false);
+    t.apply();
     }
 
 void SkiWinView::show()
     {
-    SurfaceComposerClient::openGlobalTransaction();
-    mSurfaceControl->show();
-    SurfaceComposerClient::closeGlobalTransaction();
+    SkiWinTransaction t(mBackend);
+
+    t.setVisible(this, true);
+    t.apply();
+    }
+
+bool SkiWinView::isVisible()
+    {
+    return mVisible;
+    }
+
+bool SkiWinView::isShowPending()
+    {
+    return mShowPending;
+    }
+
+/**
+ * isOccluding - Whether nothing below the view shows through it.
+ *
+ * True when it is on the screen, fully opaque, on a surface without an
+ * alpha channel, and not transformed to cover some other area. Whether
+ * lockCanvas() clears it (setOpaque()) does not matter, cleared pixels of
+ * an opaque format are still black.
+ */
+
+bool SkiWinView::isOccluding()
+    {
+    return mVisible && !mShowPending && !isTranslucent() && !hasTransform();
+    }
+
+bool SkiWinView::isTranslucent()
+    {
+    if (mAlpha < 1.0f)
+        return true;
+
+    switch (mFormat)
+        {
+        case PIXEL_FORMAT_RGBX_8888:
+        case PIXEL_FORMAT_RGB_888:
+        case PIXEL_FORMAT_RGB_565:
+            return false;
+        default:
+            return true;
+        }
+    }
+
+float SkiWinView::getAlpha()
+    {
+    return mAlpha;
+    }
+
+void SkiWinView::getMatrix(float matrix[4])
+    {
+    memcpy(matrix, mMatrix, sizeof(mMatrix));
+    }
+
+bool SkiWinView::hasTransform()
+    {
+    return mMatrix[0] != 1.0f || mMatrix[1] != 0.0f ||
+           mMatrix[2] != 0.0f || mMatrix[3] != 1.0f;
+    }
+
+int SkiWinView::getLayer()
+    {
+    return mLayer;
+    }
+
+SkIRect SkiWinView::getBounds()
+    {
+    return SkIRect::MakeXYWH(mLeft, mTop, mWidth, mHeight);
+    }
+
+/**
+ * resized - Take on a new view size set by a transaction.
+ *
+ * The content is laid out for the old size, so the whole view needs to be
+ * drawn again.
+ */
+
+void SkiWinView::resized(int w, int h)
+    {
+    Mutex::Autolock _l(mDamageLock);
+
+    mWidth = w;
+    mHeight = h;
+    mDamage.setRect(0, 0, mWidth, mHeight);
+
+    resetScrollLocked();
     }
 
 SkBitmap::Config SkiWinView::convertPixelFormat(PixelFormat format)
@@ -134,30 +274,86 @@ SkBitmap::Config SkiWinView::convertPixelFormat(PixelFormat format)
 /**
  * lockCanvas - Start editing the pixels in the surface.
  *
- * Just like lockCanvas() but allows specification of a dirty rectangle.
+ * Just like lockCanvas() but allows specification of a dirty region, NULL
+ * meaning the whole surface.
+ *
+ * The buffer queue copies the pixels outside of the dirty region back from
+ * the previous front buffer, so only the dirty region needs to be drawn.
+ * When it cannot (e.g. a freshly allocated buffer), it widens the dirty
+ * region, which is handed back to the caller as the area to redraw. The
+ * canvas is clipped to that area, which is cleared first unless the view
+ * is opaque and its content covers every pixel it draws.
+ *
+ * Returns NULL if the surface cannot be locked, the dirty region is put
+ * back as damage to be drawn by a later frame.
  *
  * This is from android/4.2/frameworks/base/core/jni/android_view_Surface.cpp
  * nativeLockCanvas().
  */
 
-SkCanvas* SkiWinView::lockCanvas(const Rect& dirtyRect)
+SkCanvas* SkiWinView::lockCanvas(SkRegion* dirty)
     {
+    if (mSurface == NULL)
+        return NULL;
+
     // get dirty region
     Region dirtyRegion;
 
-    if (!dirtyRect.isEmpty())
+    if (dirty != NULL && !dirty->isEmpty())
         {
-        dirtyRegion.set(dirtyRect);
+        SkRegion::Iterator it(*dirty);
+
+        while (!it.done())
+            {
+            const SkIRect& r = it.rect();
+
+            dirtyRegion.orSelf(Rect(r.fLeft, r.fTop, r.fRight, r.fBottom));
+            it.next();
+            }
         }
     else
         {
         dirtyRegion.set(Rect(0x3FFF, 0x3FFF));
         }
 
-    Surface::SurfaceInfo info;
+    // scrolled pixels are moved within the buffer, the buffer queue must
+    // not copy them back
+    if (mFrameScrollActive)
+        {
+        const SkIRect& r = mFrameScrollRect;
+
+        dirtyRegion.orSelf(Rect(r.fLeft, r.fTop, r.fRight, r.fBottom));
+        }
+
+    Region requested(dirtyRegion);
+    SkiWinSurfaceInfo info;
+    nsecs_t start = systemTime();
 
     status_t err = mSurface->lock(&info, &dirtyRegion);
-    assert(err == 0);
+    if (err != NO_ERROR)
+        {
+        ALOGE("lockCanvas: cannot lock surface (%d)", err);
+
+        if (dirty != NULL && !dirty->isEmpty())
+            {
+            Mutex::Autolock _l(mDamageLock);
+
+            mDamage.op(*dirty, SkRegion::kUnion_Op);
+            }
+        else
+            {
+            invalidate();
+            }
+
+        return NULL;
+        }
+
+    bool widened = !dirtyRegion.subtract(requested).isEmpty();
+
+    // the buffer may be larger than the view, the rest is cropped away
+    dirtyRegion.andSelf(Rect(mWidth, mHeight));
+
+    SkiWinFrameStats::get()->recordTime(mStatsRow, STATS_LOCK, start);
 
     SkBitmap bitmap;
 
@@ -179,10 +375,9 @@ SkCanvas* SkiWinView::lockCanvas(const Rect& dirtyRect)
         // be safe with an empty bitmap.
         bitmap.setPixels(NULL);
         }
-    
-    bitmap.eraseARGB(0, 0, 0, 0);
 
     mCanvas.setBitmapDevice(bitmap);
+    mBuffer = bitmap;
 
     SkRegion clipReg;
     if (dirtyRegion.isRect())   // very common case
@@ -201,8 +396,46 @@ SkCanvas* SkiWinView::lockCanvas(const Rect& dirtyRect)
             }
         }
 
+    if (mFrameScrollActive)
+        {
+        SkRegion redraw;
+
+        // within the scrolled area only what the move left behind, and
+        // the damage, is drawn
+        if (dirty != NULL && !dirty->isEmpty())
+            redraw.op(*dirty, mFrameScrollRect, SkRegion::kIntersect_Op);
+        else
+            redraw.setRect(mFrameScrollRect);
+
+        scrollBuffer(bitmap, widened, &redraw);
+
+        clipReg.op(mFrameScrollRect, SkRegion::kDifference_Op);
+        clipReg.op(redraw, SkRegion::kUnion_Op);
+        }
+
     mCanvas.clipRegion(clipReg);
 
+    uint64_t bytes = 0;
+
+    for (SkRegion::Iterator it(clipReg); !it.done(); it.next())
+        bytes += uint64_t(it.rect().width()) * it.rect().height();
+
+    SkiWinFrameStats::get()->record(mStatsRow, STATS_BYTES,
+                                    bytes * bitmap.bytesPerPixel());
+
+    if (!mOpaque)
+        {
+        // only the area about to be redrawn, the rest is still valid
+        mCanvas.drawColor(0, SkXfermode::kClear_Mode);
+        }
+
+    mLocked = clipReg;
+
+    if (dirty != NULL)
+        {
+        *dirty = clipReg;
+        }
+
     mCanvasSaveCount = mCanvas.save();
 
     return &mCanvas;
@@ -218,16 +451,239 @@ SkCanvas* SkiWinView::lockCanvas(const Rect& dirtyRect)
 
 void SkiWinView::unlockCanvasAndPost()
     {
+    if (mSurface == NULL)
+        return;
 
     // detach the canvas from the surface
     mCanvas.restoreToCount(mCanvasSaveCount);
 
+    scrollBufferPosted();
+
     mCanvas.setBitmapDevice(SkBitmap());
+    mBuffer.reset();
+    mLocked.setEmpty();
 
     // unlock surface
+    nsecs_t start = systemTime();
+
     status_t err = mSurface->unlockAndPost();
 
-    assert(err == 0);
+    SkiWinFrameStats::get()->recordTime(mStatsRow, STATS_POST, start);
+
+    if (err != NO_ERROR)
+        ALOGE("unlockCanvasAndPost: cannot post surface (%d)", err);
+
+    if (mShowPending)
+        show();
+    }
+
+/**
+ * getBuffer - The buffer locked by lockCanvas(), empty when not locked.
+ */
+
+SkBitmap SkiWinView::getBuffer()
+    {
+    return mBuffer;
+    }
+
+/**
+ * setFlattened - Move the view into or out of the flattened surface.
+ *
+ * A flattened view keeps its geometry and visibility, only its own surface
+ * is no longer used, it is hidden by releaseFlattenedSurface() once the
+ * flattened surface shows the view. Coming back, the surface is out of
+ * date, so the view is drawn in full and shown with its next frame just
+ * like a new one.
+ */
+
+void SkiWinView::setFlattened(bool flattened)
+    {
+    if (flattened == mFlattened)
+        return;
+
+    mFlattened = flattened;
+
+    if (flattened)
+        {
+        mVisible = mVisible || mShowPending;
+        mShowPending = false;
+        mHidePending = true;
+        }
+    else
+        {
+        mShowPending = mVisible;
+        mVisible = false;
+        mHidePending = false;
+
+        invalidate();
+        }
+
+    // the flattened surface does not keep the scrolled pixels
+    Mutex::Autolock _l(mDamageLock);
+
+    resetScrollLocked();
+    }
+
+bool SkiWinView::isFlattened()
+    {
+    return mFlattened;
+    }
+
+/**
+ * releaseFlattenedSurface - Hide the surface of a flattened view.
+ *
+ * The caller has a backend transaction open.
+ */
+
+void SkiWinView::releaseFlattenedSurface()
+    {
+    if (!mFlattened || !mHidePending)
+        return;
+
+    if (mSurface != NULL)
+        mSurface->hide();
+
+    mHidePending = false;
+    }
+
+/**
+ * lockFlattenedCanvas - Draw the view into another surface's buffer.
+ *
+ * The view's origin is at x, y in buffer, dirty is the area to redraw in
+ * view space. Like lockCanvas(), the canvas is clipped to it and cleared
+ * unless the view is opaque, only nothing is locked or posted.
+ */
+
+SkCanvas* SkiWinView::lockFlattenedCanvas(const SkBitmap& buffer,
+                                          int x, int y,
+                                          const SkRegion& dirty)
+    {
+    SkRegion clipReg(dirty);
+
+    clipReg.translate(x, y);
+
+    mCanvas.setBitmapDevice(buffer);
+    mCanvas.clipRegion(clipReg);
+
+    mBuffer = buffer;
+    mLocked = dirty;
+    mOriginX = x;
+    mOriginY = y;
+
+    uint64_t bytes = 0;
+
+    for (SkRegion::Iterator it(dirty); !it.done(); it.next())
+        bytes += uint64_t(it.rect().width()) * it.rect().height();
+
+    SkiWinFrameStats::get()->record(mStatsRow, STATS_BYTES,
+                                    bytes * buffer.bytesPerPixel());
+
+    if (!mOpaque)
+        mCanvas.drawColor(0, SkXfermode::kClear_Mode);
+
+    // the translation goes with the save, unlocking leaves no trace of it
+    mCanvasSaveCount = mCanvas.save();
+    mCanvas.translate(SkIntToScalar(x), SkIntToScalar(y));
+
+    return &mCanvas;
+    }
+
+void SkiWinView::unlockFlattenedCanvas()
+    {
+    mCanvas.restoreToCount(mCanvasSaveCount);
+
+    mCanvas.setBitmapDevice(SkBitmap());
+    mBuffer.reset();
+    mLocked.setEmpty();
+    mOriginX = 0;
+    mOriginY = 0;
+    }
+
+/**
+ * writePixels - Copy an 8888 bitmap into the locked buffer at x, y.
+ *
+ * Only the locked dirty region is written, wherever in the buffer the
+ * view is when it is flattened. A 565 buffer goes through
+ * SkiWinConvert8888To565(), dithered if the view asks for it, an 8888
+ * buffer is a plain copy. Returns false for any other combination, the
+ * caller then draws the bitmap through the canvas instead.
+ */
+
+bool SkiWinView::writePixels(const SkBitmap& src, int x, int y)
+    {
+    if (src.config() != SkBitmap::kARGB_8888_Config ||
+        mBuffer.getPixels() == NULL)
+        return false;
+
+    SkBitmap::Config config = mBuffer.config();
+
+    if (config != SkBitmap::kRGB_565_Config &&
+        config != SkBitmap::kARGB_8888_Config)
+        return false;
+
+    SkAutoLockPixels alp(src);
+
+    if (src.getPixels() == NULL)
+        return false;
+
+    SkRegion area(SkIRect::MakeXYWH(x, y, src.width(), src.height()));
+
+    if (!area.op(mLocked, SkRegion::kIntersect_Op))
+        return true;
+
+    int bpp = mBuffer.bytesPerPixel();
+
+    for (SkRegion::Iterator it(area); !it.done(); it.next())
+        {
+        const SkIRect& r = it.rect();
+
+        uint8_t* dst = (uint8_t*)mBuffer.getPixels() +
+                       (r.fTop + mOriginY) * mBuffer.rowBytes() +
+                       (r.fLeft + mOriginX) * bpp;
+        const void* pixels = src.getAddr32(r.fLeft - x, r.fTop - y);
+
+        if (config == SkBitmap::kRGB_565_Config)
+            {
+            SkiWinConvert8888To565(dst, mBuffer.rowBytes(),
+                                   pixels, src.rowBytes(),
+                                   r.width(), r.height(),
+                                   r.fLeft + mOriginX, r.fTop + mOriginY,
+                                   mDither);
+            }
+        else
+            {
+            const uint8_t* s = (const uint8_t*)pixels;
+
+            for (int row = 0; row < r.height(); row++)
+                {
+                memcpy(dst, s, r.width() * 4);
+
+                dst += mBuffer.rowBytes();
+                s += src.rowBytes();
+                }
+            }
+        }
+
+    return true;
+    }
+
+PixelFormat SkiWinView::getPixelFormat()
+    {
+    return mFormat;
+    }
+
+/**
+ * setDither - Dither 8888 content written into a 565 buffer.
+ */
+
+void SkiWinView::setDither(bool dither)
+    {
+    mDither = dither;
+    }
+
+int SkiWinView::getStatsRow()
+    {
+    return mStatsRow;
     }
 
 bool SkiWinView::isFocus(int x, int y)
@@ -239,6 +695,20 @@ bool SkiWinView::isFocus(int x, int y)
         return false;
     }
 
+/**
+ * setFocusable - Let the view take input when it is topmost under a touch.
+ */
+
+void SkiWinView::setFocusable(bool focusable)
+    {
+    mFocusable = focusable;
+    }
+
+bool SkiWinView::isFocusable()
+    {
+    return mFocusable;
+    }
+
 void SkiWinView::setContext(void * ctx)
     {
     mContext = ctx;
@@ -249,6 +719,347 @@ void* SkiWinView::getContext()
     return mContext;
     }
 
+void SkiWinView::setContentOffset(int dx, int dy)
+    {
+    mContentLeft = dx;
+    mContentTop = dy;
+    }
+
+void SkiWinView::getContentOffset(int *dx, int *dy)
+    {
+    *dx = mContentLeft;
+    *dy = mContentTop;
+    }
+
+/**
+ * setOpaque - Declare that every redraw of the view covers its dirty area.
+ *
+ * lockCanvas() then skips clearing the dirty area.
+ */
+
+void SkiWinView::setOpaque(bool opaque)
+    {
+    mOpaque = opaque;
+    }
+
+bool SkiWinView::isOpaque()
+    {
+    return mOpaque;
+    }
+
+/**
+ * setDirectRendering - Let the context window draw into the surface buffer.
+ *
+ * Instead of the SkOSWindow rendering into its own bitmap which is then
+ * copied into the locked buffer, the canvas returned by lockCanvas() is
+ * handed to the window, saving a full pass over the window and the format
+ * conversion from the window config to the surface format.
+ */
+
+void SkiWinView::setDirectRendering(bool direct)
+    {
+    mDirectRendering = direct;
+    }
+
+bool SkiWinView::isDirectRendering()
+    {
+    return mDirectRendering;
+    }
+
+/**
+ * invalidate - Mark the whole view as needing a new frame.
+ */
+
+void SkiWinView::invalidate()
+    {
+    Mutex::Autolock _l(mDamageLock);
+
+    mDamage.setRect(0, 0, mWidth, mHeight);
+    }
+
+/**
+ * invalidate - Accumulate a dirty rectangle given in view space.
+ *
+ * This may be called from the input thread as well as the SkiWin thread,
+ * the damage is consumed by the SkiWin thread through getDamage().
+ */
+
+void SkiWinView::invalidate(const SkIRect& rect)
+    {
+    SkIRect r(rect);
+
+    if (!r.intersect(0, 0, mWidth, mHeight))
+        return;
+
+    Mutex::Autolock _l(mDamageLock);
+
+    mDamage.op(r, SkRegion::kUnion_Op);
+    }
+
+/**
+ * scroll - Move the content within rect by dx, dy.
+ *
+ * The pixels already in the surface are moved within the next buffer
+ * locked instead of being drawn again. Only the part of rect the move
+ * uncovers becomes damage, which is returned in exposed, and damage not
+ * drawn yet moves along with the content. One rect is tracked at a time,
+ * scrolling another one first redraws all of the previous one.
+ *
+ * A flattened view, or a move by a whole rect or more, redraws all of rect.
+ */
+
+void SkiWinView::scroll(int dx, int dy, const SkIRect& rect, SkRegion* exposed)
+    {
+    SkIRect r(rect);
+
+    exposed->setEmpty();
+
+    if (!r.intersect(0, 0, mWidth, mHeight) || (dx | dy) == 0)
+        return;
+
+    Mutex::Autolock _l(mDamageLock);
+
+    if (mFlattened || abs(dx) >= r.width() || abs(dy) >= r.height())
+        {
+        exposed->setRect(r);
+        mDamage.op(r, SkRegion::kUnion_Op);
+        return;
+        }
+
+    if (mScrollActive && r != mScrollRect)
+        {
+        mDamage.op(mScrollRect, SkRegion::kUnion_Op);
+        resetScrollLocked();
+        }
+
+    if (!mScrollActive)
+        {
+        mScrollActive = true;
+        mScrollRect = r;
+        }
+
+    mScrollX += dx;
+    mScrollY += dy;
+
+    SkRegion moved;
+
+    if (moved.op(mDamage, r, SkRegion::kIntersect_Op))
+        {
+        moved.translate(dx, dy);
+        moved.op(r, SkRegion::kIntersect_Op);
+        }
+
+    mDamage.op(r, SkRegion::kDifference_Op);
+    mDamage.op(moved, SkRegion::kUnion_Op);
+
+    SkIRect shifted(r);
+
+    shifted.offset(dx, dy);
+
+    exposed->setRect(r);
+    exposed->op(shifted, SkRegion::kDifference_Op);
+
+    mDamage.op(*exposed, SkRegion::kUnion_Op);
+    }
+
+/**
+ * resetScrollLocked - Forget where scrolled content is in the buffers.
+ */
+
+void SkiWinView::resetScrollLocked()
+    {
+    mScrollActive = false;
+    mScrollX = 0;
+    mScrollY = 0;
+    mScrollGeneration++;
+    }
+
+/**
+ * takeScrollLocked - Remember the scroll position the damage taken is for.
+ *
+ * scroll() may move the content again before the frame is locked, its
+ * damage then goes to the next frame, and so does the move.
+ */
+
+void SkiWinView::takeScrollLocked()
+    {
+    mFrameScrollActive = mScrollActive;
+    mFrameScrollRect = mScrollRect;
+    mFrameScrollX = mScrollX;
+    mFrameScrollY = mScrollY;
+    mFrameScrollGeneration = mScrollGeneration;
+    }
+
+/**
+ * scrollBuffer - Catch a freshly locked buffer up with the scroll position.
+ *
+ * The buffer may be any of the surface's, each last posted at some scroll
+ * position. Its pixels are moved by what was scrolled since, which leaves
+ * the uncovered part and whatever was drawn into the other buffers since
+ * to be drawn, added to redraw. A buffer seen for the first time, or one
+ * the buffer queue did not copy back into, is drawn in full.
+ */
+
+void SkiWinView::scrollBuffer(SkBitmap& bitmap, bool widened,
+                              SkRegion* redraw)
+    {
+    const SkIRect& r = mFrameScrollRect;
+    ssize_t index = -1;
+
+    if (mScrollBuffersGeneration != mFrameScrollGeneration)
+        {
+        mScrollBuffers.clear();
+        mScrollBuffersGeneration = mFrameScrollGeneration;
+        }
+
+    for (size_t i = 0; i < mScrollBuffers.size(); i++)
+        {
+        if (mScrollBuffers[i].bits == bitmap.getPixels())
+            index = i;
+        }
+
+    if (index < 0 || widened)
+        {
+        if (index < 0)
+            {
+            ScrollBuffer buffer;
+
+            buffer.bits = bitmap.getPixels();
+            buffer.x = mFrameScrollX;
+            buffer.y = mFrameScrollY;
+
+            if (mScrollBuffers.size() >= MAX_SCROLL_BUFFERS)
+                mScrollBuffers.removeAt(0);
+
+            index = mScrollBuffers.add(buffer);
+            }
+
+        redraw->setRect(r);
+        }
+    else
+        {
+        const ScrollBuffer& buffer = mScrollBuffers[index];
+        int dx = mFrameScrollX - buffer.x;
+        int dy = mFrameScrollY - buffer.y;
+        SkRegion stale(buffer.stale);
+
+        if ((dx | dy) != 0)
+            {
+            SkIRect shifted(r);
+
+            shifted.offset(dx, dy);
+
+            if (bitmap.scrollRect(&r, dx, dy))
+                {
+                SkRegion exposed(r);
+
+                exposed.op(shifted, SkRegion::kDifference_Op);
+                redraw->op(exposed, SkRegion::kUnion_Op);
+                }
+            else
+                {
+                redraw->setRect(r);
+                }
+
+            stale.translate(dx, dy);
+            }
+
+        stale.op(r, SkRegion::kIntersect_Op);
+        redraw->op(stale, SkRegion::kUnion_Op);
+        }
+
+    mScrollBufferLocked = index;
+    }
+
+/**
+ * scrollBufferPosted - Record what the posted buffer holds.
+ *
+ * It is at the frame's scroll position now, every other buffer lacks what
+ * was drawn into the scrolled area of this one.
+ */
+
+void SkiWinView::scrollBufferPosted()
+    {
+    if (mScrollBufferLocked < 0)
+        return;
+
+    SkRegion drawn;
+
+    drawn.op(mLocked, mFrameScrollRect, SkRegion::kIntersect_Op);
+
+    for (size_t i = 0; i < mScrollBuffers.size(); i++)
+        {
+        ScrollBuffer& buffer = mScrollBuffers.editItemAt(i);
+
+        if (ssize_t(i) == mScrollBufferLocked)
+            {
+            buffer.x = mFrameScrollX;
+            buffer.y = mFrameScrollY;
+            buffer.stale.setEmpty();
+            }
+        else
+            {
+            SkRegion stale(drawn);
+
+            stale.translate(buffer.x - mFrameScrollX,
+                            buffer.y - mFrameScrollY);
+            buffer.stale.op(stale, SkRegion::kUnion_Op);
+            }
+        }
+
+    mScrollBufferLocked = -1;
+    }
+
+bool SkiWinView::isDirty()
+    {
+    Mutex::Autolock _l(mDamageLock);
+
+    return !mDamage.isEmpty();
+    }
+
+/**
+ * getDamage - Take the accumulated damage, leaving the view clean.
+ *
+ * Returns false if there is nothing to redraw.
+ */
+
+bool SkiWinView::getDamage(SkRegion* damage)
+    {
+    Mutex::Autolock _l(mDamageLock);
+
+    if (mDamage.isEmpty())
+        return false;
+
+    damage->swap(mDamage);
+    mDamage.setEmpty();
+
+    takeScrollLocked();
+
+    return true;
+    }
+
+/**
+ * getDamage - Take the damage within the visible part of the view.
+ *
+ * Damage nobody can see stays with the view, to be drawn once whatever
+ * covers it moves away. visible is in view space.
+ */
+
+bool SkiWinView::getDamage(SkRegion* damage, const SkRegion& visible)
+    {
+    Mutex::Autolock _l(mDamageLock);
+
+    if (mDamage.isEmpty() || !damage->op(mDamage, visible,
+                                         SkRegion::kIntersect_Op))
+        return false;
+
+    mDamage.op(visible, SkRegion::kDifference_Op);
+
+    takeScrollLocked();
+
+    return true;
+    }
+
 void SkiWinView::screenToViewSpace (int x, int y, int *x0, int* y0)
     {
     *x0 = (x - mLeft);
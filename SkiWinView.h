@@ -30,6 +30,7 @@
 #include <utils/RefBase.h>
 #include <utils/KeyedVector.h>
 #include <utils/List.h>
+#include <ui/PixelFormat.h>
 #include <input/EventHub.h>
 #include <input/InputReader.h>
 #include <input/InputApplication.h>
@@ -42,57 +43,189 @@
 #include <SkRegion.h>
 #include <SkiaSamples/SampleApp.h>
 
+#include "SkiWinSurfaceBackend.h"
+
 class SkBitmap;
 class SkCanvas;
 
 namespace android
 {
 
-class Surface;
-class SurfaceComposerClient;
-class SurfaceControl;
+class SkiWinWindowManager;
 
 // ---------------------------------------------------------------------------
 
 class SkiWinView : public RefBase
     {
     public:
-        SkiWinView(sp<SurfaceComposerClient> & client, 
+        SkiWinView(const sp<SkiWinSurfaceBackend> & backend, 
+                   const sp<SkiWinSurface> & surface,
+                   int bufferWidth, int bufferHeight,
                    const String8 & name,
-                   int x, int y, int w, int h, int l);
+                   int x, int y, int w, int h, int l,
+                   PixelFormat format = PIXEL_FORMAT_RGB_565);
         virtual ~SkiWinView();
 
-        SkCanvas* lockCanvas(const Rect& dirtyRect);
+        SkCanvas* lockCanvas(SkRegion* dirty);
         void unlockCanvasAndPost();
+        SkBitmap getBuffer();
+
+        void setFlattened(bool flattened);
+        bool isFlattened();
+        void releaseFlattenedSurface();
+        SkCanvas* lockFlattenedCanvas(const SkBitmap& buffer, int x, int y,
+                                      const SkRegion& dirty);
+        void unlockFlattenedCanvas();
         void clear();
 
+        bool writePixels(const SkBitmap& src, int x, int y);
+        PixelFormat getPixelFormat();
+        void setDither(bool dither);
+
+        int getStatsRow();
+
         void screenToViewSpace (int x, int y, int *x0, int* y0);
         void viewToScreenSpace (int x0, int y0, int *x, int* y);
         
         bool isFocus(int x, int y);
+        void setFocusable(bool focusable);
+        bool isFocusable();
         void setContext(void * ctx);
         void * getContext();
         void hide();
         void show();
+
+        bool isVisible();
+        bool isShowPending();
+        bool isOccluding();
+        bool isTranslucent();
+        float getAlpha();
+        void getMatrix(float matrix[4]);
+        bool hasTransform();
+        int getLayer();
+        SkIRect getBounds();
+
+        void setContentOffset(int dx, int dy);
+        void getContentOffset(int *dx, int *dy);
+
+        void setOpaque(bool opaque);
+        bool isOpaque();
+
+        void setDirectRendering(bool direct);
+        bool isDirectRendering();
+
+        void invalidate();
+        void invalidate(const SkIRect& rect);
+        void scroll(int dx, int dy, const SkIRect& rect, SkRegion* exposed);
+        bool isDirty();
+        bool getDamage(SkRegion* damage);
+        bool getDamage(SkRegion* damage, const SkRegion& visible);
         
     private:
+        friend class SkiWinTransaction;
+        friend class SkiWinWindowManager;
 
         SkBitmap::Config convertPixelFormat(PixelFormat format);
+        void resized(int w, int h);
+        void resetScrollLocked();
+        void takeScrollLocked();
+        void scrollBuffer(SkBitmap& bitmap, bool widened, SkRegion* redraw);
+        void scrollBufferPosted();
                 
-        sp<SurfaceComposerClient>  mSurfaceComposerClient;
-        sp<SurfaceControl> mSurfaceControl;
-        sp<Surface> mSurface;
+        sp<SkiWinSurfaceBackend> mBackend;
+        sp<SkiWinSurface> mSurface;
+
+        // the manager of this window, told about committed geometry, and
+        // its opening order, which stacks windows on the same layer
+        wp<SkiWinWindowManager> mWindowManager;
+        uint32_t mWindowOrder;
 
         SkCanvas mCanvas;
         int mCanvasSaveCount;
 
+        // the locked buffer and the part of it being redrawn, in view space,
+        // the view starting at mOriginX, mOriginY in the buffer
+        SkBitmap mBuffer;
+        SkRegion mLocked;
+        int mOriginX;
+        int mOriginY;
+
         int mLeft;
         int mTop;
         int mWidth;
         int mHeight;
         int mLayer;    
+        PixelFormat mFormat;
+
+        // size the surface is allocated at, the view is cropped out of it
+        int mBufferWidth;
+        int mBufferHeight;
+
+        // as last committed by a SkiWinTransaction
+        bool mVisible;
+        float mAlpha;
+        float mMatrix[4];
+
+        // shown once the first buffer is posted, a pooled surface still
+        // holds the last content of the window it came from
+        bool mShowPending;
+
+        // drawn into the surface of the flattening compositor instead of
+        // its own, which is hidden once that shows the view
+        bool mFlattened;
+        bool mHidePending;
 
         void * mContext;
+        bool mFocusable;
+        int mContentLeft;
+        int mContentTop;
+
+        // the context window draws straight into the locked buffer
+        bool mDirectRendering;
+
+        // redraws cover the dirty area, no need to clear it first
+        bool mOpaque;
+
+        // dither 8888 content written into a 565 buffer
+        bool mDither;
+
+        // where SkiWinFrameStats keeps the numbers of this view
+        int mStatsRow;
+
+        // accumulated damage in view space, fed from any thread
+        Mutex mDamageLock;
+        SkRegion mDamage;
+
+        // how far scroll() moved the content of mScrollRect, under
+        // mDamageLock, a new generation starts whenever that is forgotten
+        bool mScrollActive;
+        SkIRect mScrollRect;
+        int mScrollX;
+        int mScrollY;
+        uint32_t mScrollGeneration;
+
+        // the same, as of the damage taken for the frame being drawn
+        bool mFrameScrollActive;
+        SkIRect mFrameScrollRect;
+        int mFrameScrollX;
+        int mFrameScrollY;
+        uint32_t mFrameScrollGeneration;
+
+        // a buffer of the surface, known by its pixels, and where its
+        // content was scrolled to when it was last posted
+        struct ScrollBuffer
+            {
+            const void* bits;
+            int x;
+            int y;
+            // drawn into other buffers since, at this buffer's position
+            SkRegion stale;
+            };
+
+        // only touched by the thread drawing the view
+        Vector<ScrollBuffer> mScrollBuffers;
+        uint32_t mScrollBuffersGeneration;
+        ssize_t mScrollBufferLocked;
     };
 
 // ---------------------------------------------------------------------------
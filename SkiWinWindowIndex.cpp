@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define LOG_TAG "SkiWinWindowIndex"
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include "SkiWinWindowIndex.h"
+
+namespace android
+{
+
+SkiWinWindowIndex::SkiWinWindowIndex(int width, int height, int cellSize) :
+    mCellSize(cellSize)
+    {
+    if (mCellSize < 1)
+        mCellSize = 1;
+
+    mColumns = (width + mCellSize - 1) / mCellSize;
+    mRows = (height + mCellSize - 1) / mCellSize;
+
+    if (mColumns < 1)
+        mColumns = 1;
+    if (mRows < 1)
+        mRows = 1;
+
+    mCells = new Vector<Entry>[mColumns * mRows];
+    }
+
+SkiWinWindowIndex::~SkiWinWindowIndex()
+    {
+    delete[] mCells;
+    }
+
+/**
+ * cellRange - Cells a rectangle overlaps, false if none.
+ *
+ * Windows hanging off the screen are kept in the edge cells, a point off
+ * the screen is looked up in the edge cell next to it.
+ */
+
+bool SkiWinWindowIndex::cellRange(const SkIRect& bounds, int* left, int* top,
+                                  int* right, int* bottom) const
+    {
+    if (bounds.isEmpty())
+        return false;
+
+    *left = SkClampMax(bounds.fLeft / mCellSize, mColumns - 1);
+    *top = SkClampMax(bounds.fTop / mCellSize, mRows - 1);
+    *right = SkClampMax((bounds.fRight - 1) / mCellSize, mColumns - 1);
+    *bottom = SkClampMax((bounds.fBottom - 1) / mCellSize, mRows - 1);
+
+    return true;
+    }
+
+void SkiWinWindowIndex::addToCells(const Entry& entry)
+    {
+    int left, top, right, bottom;
+
+    if (!cellRange(entry.bounds, &left, &top, &right, &bottom))
+        return;
+
+    for (int y = top; y <= bottom; y++)
+        {
+        for (int x = left; x <= right; x++)
+            {
+            Vector<Entry>& cell = mCells[y * mColumns + x];
+            size_t i = 0;
+
+            while (i < cell.size() && isAbove(cell[i], entry))
+                i++;
+
+            cell.insertAt(entry, i);
+            }
+        }
+    }
+
+void SkiWinWindowIndex::removeFromCells(const Entry& entry)
+    {
+    int left, top, right, bottom;
+
+    if (!cellRange(entry.bounds, &left, &top, &right, &bottom))
+        return;
+
+    for (int y = top; y <= bottom; y++)
+        {
+        for (int x = left; x <= right; x++)
+            {
+            Vector<Entry>& cell = mCells[y * mColumns + x];
+
+            for (size_t i = 0; i < cell.size(); i++)
+                {
+                if (cell[i].view == entry.view)
+                    {
+                    cell.removeAt(i);
+                    break;
+                    }
+                }
+            }
+        }
+    }
+
+/**
+ * update - Add a window, or move it to new bounds and stacking order.
+ *
+ * order breaks ties between windows on the same layer, higher on top.
+ */
+
+void SkiWinWindowIndex::update(SkiWinView* view, const SkIRect& bounds,
+                               int32_t layer, uint32_t order)
+    {
+    Entry entry;
+
+    entry.view = view;
+    entry.bounds = bounds;
+    entry.layer = layer;
+    entry.order = order;
+
+    ssize_t index = mEntries.indexOfKey(view);
+
+    if (index >= 0)
+        {
+        const Entry& old = mEntries.valueAt(index);
+
+        if (old.bounds == bounds && old.layer == layer && old.order == order)
+            return;
+
+        removeFromCells(old);
+        mEntries.replaceValueAt(index, entry);
+        }
+    else
+        {
+        mEntries.add(view, entry);
+        }
+
+    addToCells(entry);
+    }
+
+void SkiWinWindowIndex::remove(SkiWinView* view)
+    {
+    ssize_t index = mEntries.indexOfKey(view);
+
+    if (index < 0)
+        return;
+
+    removeFromCells(mEntries.valueAt(index));
+    mEntries.removeItemsAt(index);
+    }
+
+SkiWinView* SkiWinWindowIndex::findTopmost(int x, int y) const
+    {
+    int column = SkClampMax(x / mCellSize, mColumns - 1);
+    int row = SkClampMax(y / mCellSize, mRows - 1);
+    const Vector<Entry>& cell = mCells[row * mColumns + column];
+
+    for (size_t i = 0; i < cell.size(); i++)
+        {
+        if (cell[i].bounds.contains(x, y))
+            return cell[i].view;
+        }
+
+    return NULL;
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
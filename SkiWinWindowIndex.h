@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_SKIWIN_WINDOW_INDEX_H
+#define ANDROID_SKIWIN_WINDOW_INDEX_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/KeyedVector.h>
+#include <utils/Vector.h>
+
+#include <SkRect.h>
+
+namespace android
+{
+
+class SkiWinView;
+
+// ---------------------------------------------------------------------------
+
+/*
+ * SkiWinWindowIndex - Which window is on top at a point of the screen.
+ *
+ * The screen is split into a uniform grid of cells, every cell lists the
+ * windows overlapping it from the top down. A lookup goes to the one cell
+ * under the point and takes the first window there that contains it, so
+ * its cost depends on how many windows overlap at that spot rather than
+ * on how many there are. Moving a window only touches the cells it left
+ * and the ones it entered.
+ *
+ * Not thread safe, SkiWinWindowManager calls it under its lock. Windows
+ * are held by raw pointer, they must be removed before they go away.
+ */
+
+class SkiWinWindowIndex
+    {
+    public:
+        SkiWinWindowIndex(int width, int height, int cellSize);
+        ~SkiWinWindowIndex();
+
+        void update(SkiWinView* view, const SkIRect& bounds,
+                    int32_t layer, uint32_t order);
+        void remove(SkiWinView* view);
+
+        SkiWinView* findTopmost(int x, int y) const;
+
+    private:
+        struct Entry
+            {
+            SkiWinView* view;
+            SkIRect bounds;
+            int32_t layer;
+            uint32_t order;
+            };
+
+        static bool isAbove(const Entry& a, const Entry& b)
+            {
+            return a.layer > b.layer ||
+                   (a.layer == b.layer && a.order > b.order);
+            }
+
+        bool cellRange(const SkIRect& bounds, int* left, int* top,
+                       int* right, int* bottom) const;
+        void addToCells(const Entry& entry);
+        void removeFromCells(const Entry& entry);
+
+        int mColumns;
+        int mRows;
+        int mCellSize;
+
+        // mColumns * mRows cells, each topmost window first
+        Vector<Entry>* mCells;
+
+        KeyedVector<SkiWinView*, Entry> mEntries;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_WINDOW_INDEX_H
@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define LOG_TAG "SkiWinWindowManager"
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include "SkiWinEventPump.h"
+#include "SkiWinTransaction.h"
+#include "SkiWinWindowManager.h"
+
+// grid cell size of the hit testing index, in pixels
+#define WINDOW_INDEX_CELL_SIZE  32
+
+namespace android
+{
+
+SkiWinWindowManager::SkiWinWindowManager(
+    const sp<SkiWinSurfaceBackend>& backend, size_t poolBudget) :
+    mBackend(backend), mPool(backend, poolBudget), mTopLayer(LAYER_BASE - 1),
+    mNextOrder(0)
+    {
+    int w = 0, h = 0;
+
+    mBackend->getDisplaySize(&w, &h);
+
+    mIndex = new SkiWinWindowIndex(w, h, WINDOW_INDEX_CELL_SIZE);
+    }
+
+SkiWinWindowManager::~SkiWinWindowManager()
+    {
+    delete mIndex;
+
+    mWindows.clear();
+    mPool.purge();
+    }
+
+/**
+ * createWindow - Open a window, on a pooled surface if there is one.
+ *
+ * The window shows up with its first frame, which is drawn as soon as the
+ * SkiWin thread gets to it since a new view is damaged all over.
+ */
+
+sp<SkiWinView> SkiWinWindowManager::createWindow(const String8& name,
+                                                 int x, int y, int w, int h,
+                                                 int32_t layer,
+                                                 PixelFormat format)
+    {
+    int bufferWidth, bufferHeight;
+
+    if (w <= 0 || h <= 0)
+        return NULL;
+
+    sp<SkiWinSurface> surface = mPool.acquire(name, w, h, format,
+                                              &bufferWidth, &bufferHeight);
+    if (surface == NULL)
+        return NULL;
+
+    sp<SkiWinView> view;
+
+        {
+        Mutex::Autolock _l(mLock);
+
+        if (layer == LAYER_AUTO)
+            layer = mTopLayer + 1;
+
+        view = new SkiWinView(mBackend, surface, bufferWidth, bufferHeight,
+                              name, x, y, w, h, layer, format);
+
+        view->mWindowManager = this;
+        view->mWindowOrder = mNextOrder++;
+
+        insertLocked(view);
+        indexLocked(view);
+        }
+
+    wake();
+
+    return view;
+    }
+
+/**
+ * destroyWindow - Close a window and give its surface back to the pool.
+ *
+ * Waits for a frame in progress to finish. The view can still be held on
+ * to, it just has no surface any more.
+ */
+
+void SkiWinWindowManager::destroyWindow(const sp<SkiWinView>& view)
+    {
+    Mutex::Autolock _f(mFrameLock);
+
+        {
+        Mutex::Autolock _l(mLock);
+        ssize_t index = indexOfLocked(view);
+
+        if (index < 0)
+            return;
+
+        mWindows.removeAt(index);
+        mIndex->remove(view.get());
+
+        mTopLayer = LAYER_BASE - 1;
+
+        for (size_t i = 0; i < mWindows.size(); i++)
+            {
+            if (mWindows[i]->mLayer > mTopLayer)
+                mTopLayer = mWindows[i]->mLayer;
+            }
+        }
+
+    releaseWindow(view);
+    }
+
+/**
+ * createCompositorWindow - A window SkiWin draws into itself.
+ *
+ * It has a surface from the pool like any window, but is not one of the
+ * windows, it is not drawn in frames or hit tested. Only the SkiWin thread
+ * uses it, so it can be created and destroyed in the middle of a frame.
+ */
+
+sp<SkiWinView> SkiWinWindowManager::createCompositorWindow(
+    const String8& name, int x, int y, int w, int h, int32_t layer,
+    PixelFormat format)
+    {
+    int bufferWidth, bufferHeight;
+
+    if (w <= 0 || h <= 0)
+        return NULL;
+
+    sp<SkiWinSurface> surface = mPool.acquire(name, w, h, format,
+                                              &bufferWidth, &bufferHeight);
+    if (surface == NULL)
+        return NULL;
+
+    return new SkiWinView(mBackend, surface, bufferWidth, bufferHeight,
+                          name, x, y, w, h, layer, format);
+    }
+
+void SkiWinWindowManager::destroyCompositorWindow(const sp<SkiWinView>& view)
+    {
+    releaseWindow(view);
+    }
+
+void SkiWinWindowManager::releaseWindow(const sp<SkiWinView>& view)
+    {
+    if (view->mSurface == NULL)
+        return;
+
+    SkiWinTransaction t(mBackend);
+
+    view->setFlattened(false);
+
+    t.setVisible(view, false);
+    t.apply();
+
+    mPool.release(view->mSurface, view->mBufferWidth, view->mBufferHeight,
+                  view->mFormat);
+
+    view->mSurface = NULL;
+    }
+
+/**
+ * moveWindow - Move a window on the screen.
+ *
+ * Like the other geometry changes, waits for a frame in progress to
+ * finish, the frame reads the geometry and may have the surface locked.
+ */
+
+status_t SkiWinWindowManager::moveWindow(const sp<SkiWinView>& view,
+                                         int x, int y)
+    {
+    Mutex::Autolock _f(mFrameLock);
+    SkiWinTransaction t(mBackend);
+
+    t.setPosition(view, x, y);
+
+    // SurfaceFlinger recomposes, none of the content changes
+    return t.apply();
+    }
+
+/**
+ * resizeWindow - Change the size of a window.
+ *
+ * Within the buffers the window already has this is only a new crop,
+ * growing beyond them reallocates at the next bucket size.
+ */
+
+status_t SkiWinWindowManager::resizeWindow(const sp<SkiWinView>& view,
+                                           int w, int h)
+    {
+    if (w <= 0 || h <= 0)
+        return BAD_VALUE;
+
+    Mutex::Autolock _f(mFrameLock);
+    SkiWinTransaction t(mBackend);
+
+    t.setSize(view, w, h);
+
+    return t.apply();
+    }
+
+/**
+ * setWindowLayer - Restack a window, on top of others on the same layer.
+ */
+
+status_t SkiWinWindowManager::setWindowLayer(const sp<SkiWinView>& view,
+                                             int32_t layer)
+    {
+    Mutex::Autolock _f(mFrameLock);
+    SkiWinTransaction t(mBackend);
+
+    t.setLayer(view, layer);
+
+    return t.apply();
+    }
+
+/**
+ * windowChanged - Catch up with geometry a transaction has committed.
+ */
+
+void SkiWinWindowManager::windowChanged(const sp<SkiWinView>& view,
+                                        bool restacked)
+    {
+        {
+        Mutex::Autolock _l(mLock);
+        ssize_t index = indexOfLocked(view);
+
+        // closed, or never one of ours
+        if (index < 0)
+            return;
+
+        if (restacked)
+            {
+            mWindows.removeAt(index);
+            view->mWindowOrder = mNextOrder++;
+            insertLocked(view);
+            }
+
+        indexLocked(view);
+        }
+
+    // windows below may have come into view with damage still to draw
+    wake();
+    }
+
+ssize_t SkiWinWindowManager::indexOfLocked(const sp<SkiWinView>& view)
+    {
+    for (size_t i = 0; i < mWindows.size(); i++)
+        {
+        if (mWindows[i] == view)
+            return i;
+        }
+
+    return -1;
+    }
+
+void SkiWinWindowManager::insertLocked(const sp<SkiWinView>& view)
+    {
+    size_t i = mWindows.size();
+
+    // equal layers keep the order they were opened in
+    while (i > 0 && mWindows[i - 1]->mLayer > view->mLayer)
+        i--;
+
+    mWindows.insertAt(view, i);
+
+    if (view->mLayer > mTopLayer)
+        mTopLayer = view->mLayer;
+    }
+
+/**
+ * indexLocked - Bring the hit testing index up to date with a window.
+ *
+ * Only shown windows can be hit, one waiting for its first frame is not on
+ * the screen yet.
+ */
+
+void SkiWinWindowManager::indexLocked(const sp<SkiWinView>& view)
+    {
+    if (view->mVisible)
+        mIndex->update(view.get(), view->getBounds(), view->mLayer,
+                       view->mWindowOrder);
+    else
+        mIndex->remove(view.get());
+    }
+
+/**
+ * findWindowAt - Topmost shown window at a screen position, or NULL.
+ *
+ * Called for every motion event, it does not walk the window list.
+ */
+
+sp<SkiWinView> SkiWinWindowManager::findWindowAt(int x, int y)
+    {
+    Mutex::Autolock _l(mLock);
+
+    return mIndex->findTopmost(x, y);
+    }
+
+/**
+ * getWindows - Snapshot of the open windows, bottom to top.
+ */
+
+void SkiWinWindowManager::getWindows(Vector< sp<SkiWinView> >* views)
+    {
+    Mutex::Autolock _l(mLock);
+
+    *views = mWindows;
+    }
+
+size_t SkiWinWindowManager::getWindowCount()
+    {
+    Mutex::Autolock _l(mLock);
+
+    return mWindows.size();
+    }
+
+void SkiWinWindowManager::wake()
+    {
+    SkiWinEventPump::get()->wake();
+    }
+
+void SkiWinWindowManager::dump()
+    {
+        {
+        Mutex::Autolock _l(mLock);
+
+        for (size_t i = 0; i < mWindows.size(); i++)
+            {
+            const sp<SkiWinView>& view = mWindows[i];
+            SkIRect r = view->getBounds();
+
+            ALOGD("window %d: layer 0x%x, %d,%d %dx%d in %dx%d%s",
+                  int(i), view->mLayer, r.fLeft, r.fTop, r.width(), r.height(),
+                  view->mBufferWidth, view->mBufferHeight,
+                  view->mVisible ? "" : ", hidden");
+            }
+        }
+
+    mPool.dump();
+    }
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_SKIWIN_WINDOW_MANAGER_H
+#define ANDROID_SKIWIN_WINDOW_MANAGER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <ui/PixelFormat.h>
+#include <utils/RefBase.h>
+#include <utils/String8.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+#include "SkiWinSurfaceBackend.h"
+#include "SkiWinSurfacePool.h"
+#include "SkiWinView.h"
+#include "SkiWinWindowIndex.h"
+
+namespace android
+{
+
+// ---------------------------------------------------------------------------
+
+/*
+ * SkiWinWindowManager - Windows opened, closed, moved and resized at run
+ * time.
+ *
+ * Every window is a SkiWinView on a surface from the pool. The manager
+ * keeps them in z order, a window created without a layer goes on top of
+ * all others. Geometry changes go through SkiWinTransaction and wake the
+ * SkiWin thread, which redraws what they damaged in the next frame. Every
+ * committed change, wherever the transaction came from, also updates the
+ * index findWindowAt() answers from.
+ *
+ * The SkiWin thread holds the frame lock while it draws. A window is only
+ * taken away, moved, resized or restacked between frames, so a frame never
+ * sees its geometry change or its surface recycled while it is locked.
+ * None of these may be called from drawing code.
+ */
+
+class SkiWinWindowManager : public RefBase
+    {
+    public:
+        enum
+            {
+            LAYER_BASE = 0x40000000,
+            LAYER_AUTO = -1
+            };
+
+        SkiWinWindowManager(const sp<SkiWinSurfaceBackend>& backend,
+                            size_t poolBudget);
+        virtual ~SkiWinWindowManager();
+
+        sp<SkiWinView> createWindow(const String8& name,
+                                    int x, int y, int w, int h,
+                                    int32_t layer = LAYER_AUTO,
+                                    PixelFormat format = PIXEL_FORMAT_RGB_565);
+        void destroyWindow(const sp<SkiWinView>& view);
+
+        sp<SkiWinView> createCompositorWindow(const String8& name,
+                                              int x, int y, int w, int h,
+                                              int32_t layer,
+                                              PixelFormat format);
+        void destroyCompositorWindow(const sp<SkiWinView>& view);
+
+        status_t moveWindow(const sp<SkiWinView>& view, int x, int y);
+        status_t resizeWindow(const sp<SkiWinView>& view, int w, int h);
+        status_t setWindowLayer(const sp<SkiWinView>& view, int32_t layer);
+
+        void getWindows(Vector< sp<SkiWinView> >* views);
+        size_t getWindowCount();
+
+        sp<SkiWinView> findWindowAt(int x, int y);
+
+        Mutex& getFrameLock()
+            {
+            return mFrameLock;
+            }
+
+        SkiWinSurfacePool& getSurfacePool()
+            {
+            return mPool;
+            }
+
+        void dump();
+
+    private:
+        friend class SkiWinTransaction;
+
+        void windowChanged(const sp<SkiWinView>& view, bool restacked);
+
+        ssize_t indexOfLocked(const sp<SkiWinView>& view);
+        void insertLocked(const sp<SkiWinView>& view);
+        void indexLocked(const sp<SkiWinView>& view);
+        void releaseWindow(const sp<SkiWinView>& view);
+        void wake();
+
+        sp<SkiWinSurfaceBackend> mBackend;
+        SkiWinSurfacePool mPool;
+
+        // held by the SkiWin thread for the whole of a frame
+        Mutex mFrameLock;
+
+        Mutex mLock;
+
+        // bottom to top
+        Vector< sp<SkiWinView> > mWindows;
+        int32_t mTopLayer;
+        uint32_t mNextOrder;
+
+        // visible windows by screen position
+        SkiWinWindowIndex* mIndex;
+    };
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
+
+#endif // ANDROID_SKIWIN_WINDOW_MANAGER_H
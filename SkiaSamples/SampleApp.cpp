@@ -15,6 +15,7 @@
 #include "SkPaint.h"
 #include "SkPicture.h"
 #include "SkStream.h"
+#include "SkThread.h"
 #include "SkTime.h"
 #include "SkWindow.h"
 #include "gl/SkNativeGLContext.h"
@@ -587,6 +588,27 @@ bool SampleCode::FastTextQ(const SkEvent& evt)
 static SkMSec gAnimTime;
 static SkMSec gAnimTimePrev;
 
+/*
+ * Moves the animation clock on to now, once per frame, before any window
+ * of the frame draws. The host calls it, so windows drawn on different
+ * threads all see the same time and delta.
+ */
+
+void SampleWindow::AdvanceAnimTime()
+    {
+    if (!gAnimTimePrev && !gAnimTime)
+        {
+        // first time make delta be 0
+        gAnimTime = SkTime::GetMSecs();
+        gAnimTimePrev = gAnimTime;
+        }
+    else
+        {
+        gAnimTimePrev = gAnimTime;
+        gAnimTime = SkTime::GetMSecs();
+        }
+    }
+
 SkMSec SampleCode::GetAnimTime()
     {
     return gAnimTime;
@@ -743,7 +765,6 @@ SampleWindow::SampleWindow(void* hwnd, int argc, char** argv, DeviceManager* dev
     fFilterState = SkOSMenu::kMixedState;
     fHintingState = SkOSMenu::kMixedState;
     fFlipAxis = 0;
-    fScrollTestX = fScrollTestY = 0;
 
     fMouseX = fMouseY = 0;
     fFatBitsScale = 8;
@@ -753,6 +774,8 @@ SampleWindow::SampleWindow(void* hwnd, int argc, char** argv, DeviceManager* dev
     fZoomLevel = 0;
     fZoomScale = SK_Scalar1;
 
+    fTouchCount = 0;
+
     fMagnify = false;
     fDebugger = false;
 
@@ -969,18 +992,6 @@ void SampleWindow::draw(SkCanvas* canvas)
         {
         return;
         }
-    // update the animation time
-    if (!gAnimTimePrev && !gAnimTime)
-        {
-        // first time make delta be 0
-        gAnimTime = SkTime::GetMSecs();
-        gAnimTimePrev = gAnimTime;
-        }
-    else
-        {
-        gAnimTimePrev = gAnimTime;
-        gAnimTime = SkTime::GetMSecs();
-        }
 
     const SkMatrix& localM = fGesture.localM();
     if (localM.getType() & SkMatrix::kScale_Mask)
@@ -1029,6 +1040,25 @@ void SampleWindow::draw(SkCanvas* canvas)
             {
             }
         }
+    else if (!fGestureFrame.isNull())
+        {
+        // scale the frame from the start of the gesture to where the
+        // fingers moved it, the sample is drawn again when they lift
+        SkAutoCanvasRestore acr(canvas, true);
+        SkMatrix m, inverse;
+        SkPaint paint;
+
+        this->getLocalMatrix(&m);
+        if (fGestureFrameMatrix.invert(&inverse))
+            {
+            m.preConcat(inverse);
+            }
+
+        paint.setFilterBitmap(true);
+        canvas->drawColor(SK_ColorWHITE);
+        canvas->concat(m);
+        canvas->drawBitmap(fGestureFrame, 0, 0, &paint);
+        }
     else
         {
         this->INHERITED::draw(canvas);
@@ -1240,15 +1270,31 @@ SkCanvas* SampleWindow::beforeChildren(SkCanvas* canvas)
     return canvas;
     }
 
-static void paint_rgn(const SkBitmap& bm, const SkIRect& r,
-                      const SkRegion& rgn)
+/*
+ * Moving the pixels of r by dx, dy in the window and wherever it is shown
+ * leaves only the part the move uncovers to be drawn again. The host
+ * implements SkiWinScrollWindow(), returning false when it cannot.
+ */
+
+bool SampleWindow::scroll(int dx, int dy, const SkIRect& r)
     {
-    SkCanvas    canvas(bm);
-    SkRegion    inval(rgn);
+    SkRegion exposed;
+
+    if (!SkiWinScrollWindow(this, dx, dy, r, &exposed))
+        {
+        this->inval(NULL);
+        return false;
+        }
+
+    for (SkRegion::Iterator it(exposed); !it.done(); it.next())
+        {
+        SkRect rect;
+
+        rect.set(it.rect());
+        this->inval(&rect);
+        }
 
-    inval.translate(r.fLeft, r.fTop);
-    canvas.clipRegion(inval);
-    canvas.drawColor(0xFFFF8080);
+    return true;
     }
 #include "SkData.h"
 void SampleWindow::afterChildren(SkCanvas* orig)
@@ -1299,9 +1345,10 @@ void SampleWindow::afterChildren(SkCanvas* orig)
         SkBitmap bmp;
         if (device->accessBitmap(false).copyTo(&bmp, SkBitmap::kARGB_8888_Config))
             {
-            static int gSampleGrabCounter;
+            // windows may draw on different threads, each grab its own name
+            static int32_t gSampleGrabCounter;
             SkString name;
-            name.printf("sample_grab_%d", gSampleGrabCounter++);
+            name.printf("sample_grab_%d", sk_atomic_inc(&gSampleGrabCounter));
             SkImageEncoder::EncodeFile(name.c_str(), bmp,
                                        SkImageEncoder::kPNG_Type, 100);
             }
@@ -1344,19 +1391,6 @@ void SampleWindow::afterChildren(SkCanvas* orig)
         this->postInvalDelay();
         }
 
-    //    if ((fScrollTestX | fScrollTestY) != 0)
-    if (false)
-        {
-        const SkBitmap& bm = orig->getDevice()->accessBitmap(true);
-        int dx = fScrollTestX * 7;
-        int dy = fScrollTestY * 7;
-        SkIRect r;
-        SkRegion inval;
-
-        r.set(50, 50, 50+100, 50+100);
-        bm.scrollRect(&r, dx, dy, &inval);
-        paint_rgn(bm, r, inval);
-        }
 #ifdef DEBUGGER
     SkView* curr = curr_view(this);
     if (fDebugger && !is_debugger(curr) && !is_transition(curr) && !is_overview(curr))
@@ -1803,14 +1837,15 @@ bool SampleWindow::onHandleChar(SkUnichar uni)
         {
         if ((dx | dy) == 0)
             {
-            fScrollTestX = fScrollTestY = 0;
+            this->inval(NULL);
             }
         else
             {
-            fScrollTestX += dx;
-            fScrollTestY += dy;
+            SkIRect r;
+
+            r.set(50, 50, 50+100, 50+100);
+            this->scroll(dx * 7, dy * 7, r);
             }
-        this->inval(NULL);
         return true;
         }
 
@@ -2031,6 +2066,41 @@ SkView::Click* SampleWindow::onFindClickHandler(SkScalar x, SkScalar y)
     return new GestureClick(this);
     }
 
+/*
+ * One pointer of a touch, the host calls this for each of them. ownerId
+ * keeps the pointers apart, two of them pinch and rotate through fGesture.
+ */
+
+bool SampleWindow::handleTouch(int ownerId, float x, float y,
+                               SkView::Click::State state)
+    {
+    void* owner = reinterpret_cast<void*>(static_cast<intptr_t>(ownerId));
+
+    return this->handleClick(SkScalarRound(x), SkScalarRound(y), state, owner);
+    }
+
+/*
+ * Draws the sample once into a bitmap as the fingers start moving, the
+ * frames of the gesture only scale that instead of drawing the sample at
+ * every step. Animations stop until the gesture ends.
+ */
+
+void SampleWindow::cacheGestureFrame()
+    {
+    fGestureFrame.setConfig(SkBitmap::kARGB_8888_Config,
+                            SkScalarRound(this->width()),
+                            SkScalarRound(this->height()));
+    if (!fGestureFrame.allocPixels())
+        {
+        fGestureFrame.reset();
+        return;
+        }
+
+    SkCanvas canvas(fGestureFrame);
+    this->INHERITED::draw(&canvas);
+    this->getLocalMatrix(&fGestureFrameMatrix);
+    }
+
 bool SampleWindow::onClick(Click* click)
     {
     if (GestureClick::IsGesture(click))
@@ -2042,13 +2112,23 @@ bool SampleWindow::onClick(Click* click)
             {
             case SkView::Click::kDown_State:
                 fGesture.touchBegin(click->fOwner, x, y);
+                fTouchCount++;
                 break;
             case SkView::Click::kMoved_State:
+                // taps never get here, they are not worth the cache
+                if (fGestureFrame.isNull())
+                    {
+                    this->cacheGestureFrame();
+                    }
                 fGesture.touchMoved(click->fOwner, x, y);
                 this->updateMatrix();
                 break;
             case SkView::Click::kUp_State:
                 fGesture.touchEnd(click->fOwner);
+                if (fTouchCount > 0 && --fTouchCount == 0)
+                    {
+                    fGestureFrame.reset();
+                    }
                 this->updateMatrix();
                 break;
             }
@@ -2063,6 +2143,7 @@ void SampleWindow::loadView(SkView* view)
     {
     SkView::F2BIter iter(this);
     SkView* prev = iter.next();
+    fGestureFrame.reset();
     if (prev)
         {
         prev->detachFromParent();
@@ -2193,6 +2274,7 @@ void SampleWindow::updateTitle()
 void SampleWindow::onSizeChange()
     {
     this->INHERITED::onSizeChange();
+    fGestureFrame.reset();
 
     SkView::F2BIter iter(this);
     SkView* view = iter.next();
@@ -28,6 +28,11 @@ class SkCanvas;
 class SkPicture;
 class SkTypeface;
 class SkData;
+class SkRegion;
+
+// moves the pixels shown for the window, implemented by the host
+extern bool SkiWinScrollWindow(SkOSWindow* window, int dx, int dy,
+                               const SkIRect& r, SkRegion* exposed);
 
 class SampleWindow : public SkOSWindow
     {
@@ -102,6 +107,8 @@ class SampleWindow : public SkOSWindow
         int  sampleCount();
         bool handleTouch(int ownerId, float x, float y,
                          SkView::Click::State state);
+        bool scroll(int dx, int dy, const SkIRect& r);
+        static void AdvanceAnimTime();
         void saveToPdf();
         SkData* getPDFData()
             {
@@ -137,6 +144,10 @@ class SampleWindow : public SkOSWindow
         SkPath fClipPath;
 
         SkTouchGesture fGesture;
+        int fTouchCount;
+        // frame scaled while fingers are down, and the matrix it was drawn at
+        SkBitmap fGestureFrame;
+        SkMatrix fGestureFrameMatrix;
         SkScalar fZoomLevel;
         SkScalar fZoomScale;
 
@@ -178,7 +189,6 @@ class SampleWindow : public SkOSWindow
         SkOSMenu::TriState fHintingState;
         unsigned   fFlipAxis;
 
-        int fScrollTestX, fScrollTestY;
         SkScalar fZoomCenterX, fZoomCenterY;
 
         //Stores global settings
@@ -197,6 +207,7 @@ class SampleWindow : public SkOSWindow
         void magnify(SkCanvas* canvas);
         void showZoomer(SkCanvas* canvas);
         void updateMatrix();
+        void cacheGestureFrame();
         void postAnimatingEvent();
         void installDrawFilter(SkCanvas*);
 
@@ -27,17 +27,44 @@ static void set2x3(SkMatrix* m, float a, float b, float c, float d, float e, flo
     m->set(5, f);
     }
 
-static SkRandom gRand;
-static bool return_large;
-static bool return_undef;
-static bool quick;
-static bool scale_large;
-static int scval = 1;
-static float transval = 0;
-
-static int R(float x)
+/*
+ * The fuzzing state, one per view, so views drawn on different threads do
+ * not share a random sequence.
+ */
+
+class Fuzzer
     {
-    return (int)floor(SkScalarToFloat(gRand.nextUScalar1()) * x);
+    public:
+        Fuzzer()
+            {
+            fReturnLarge = false;
+            fReturnUndef = false;
+            fQuick = false;
+            fScaleLarge = false;
+            fScval = 1;
+            fTransval = 0;
+            }
+
+        void do_fuzz(SkCanvas* canvas);
+
+    private:
+        int R(float x);
+        float make_number();
+        SkColor make_color();
+        SkColor make_fill();
+
+        SkRandom fRand;
+        bool fReturnLarge;
+        bool fReturnUndef;
+        bool fQuick;
+        bool fScaleLarge;
+        int fScval;
+        float fTransval;
+    };
+
+int Fuzzer::R(float x)
+    {
+    return (int)floor(SkScalarToFloat(fRand.nextUScalar1()) * x);
     }
 
 static float huge()
@@ -47,14 +74,14 @@ static float huge()
     return f;
     }
 
-static float make_number()
+float Fuzzer::make_number()
     {
     float v = 0;
     int sel;
 
-    if (return_large == true && R(3) == 1) sel = R(6);
+    if (fReturnLarge == true && R(3) == 1) sel = R(6);
     else  sel = R(4);
-    if (return_undef == false && sel == 0) sel = 1;
+    if (fReturnUndef == false && sel == 0) sel = 1;
 
     if (R(2) == 1) v = (float)R(100);
     else
@@ -84,19 +111,19 @@ static float make_number()
     return v;
     }
 
-static SkColor make_color()
+SkColor Fuzzer::make_color()
     {
     if (R(2) == 1) return 0xFFC0F0A0;
     else return 0xFF000090;
     }
 
 
-static SkColor make_fill()
+SkColor Fuzzer::make_fill()
     {
 #if 0
     int sel;
 
-    if (quick == true) sel = 0;
+    if (fQuick == true) sel = 0;
     else sel = R(6);
 
     switch (sel)
@@ -135,7 +162,7 @@ static SkColor make_fill()
     }
 
 
-static void do_fuzz(SkCanvas* canvas)
+void Fuzzer::do_fuzz(SkCanvas* canvas)
     {
     SkPath path;
     SkPaint paint;
@@ -151,7 +178,7 @@ static void do_fuzz(SkCanvas* canvas)
                 break;
 
             case 1:
-                paint.setAlpha(gRand.nextU() & 0xFF);
+                paint.setAlpha(fRand.nextU() & 0xFF);
                 break;
 
             case 2:
@@ -207,17 +234,17 @@ static void do_fuzz(SkCanvas* canvas)
                 break;
 
             case 7:
-                if (quick == true) break;
+                if (fQuick == true) break;
                 SkSafeUnref(paint.setMaskFilter(SkBlurMaskFilter::Create(make_number(), SkBlurMaskFilter::kNormal_BlurStyle)));
                 break;
 
             case 8:
-                if (quick == true) break;
+                if (fQuick == true) break;
                 //ctx.shadowColor = make_fill();
                 break;
 
             case 9:
-                if (quick == true) break;
+                if (fQuick == true) break;
                 //ctx.shadowOffsetX = make_number();
                 //ctx.shadowOffsetY = make_number();
                 break;
@@ -240,17 +267,17 @@ static void do_fuzz(SkCanvas* canvas)
 
             case 14:
 
-                if (quick == true) break;
+                if (fQuick == true) break;
 
-                if (transval == 0)
+                if (fTransval == 0)
                     {
-                    transval = make_number();
-                    canvas->translate(transval,0);
+                    fTransval = make_number();
+                    canvas->translate(fTransval,0);
                     }
                 else
                     {
-                    canvas->translate(-transval,0);
-                    transval = 0;
+                    canvas->translate(-fTransval,0);
+                    fTransval = 0;
                     }
 
                 break;
@@ -268,7 +295,7 @@ static void do_fuzz(SkCanvas* canvas)
             break;
 
             case 16:
-                if (quick == true) break;
+                if (fQuick == true) break;
 //      ctx.drawImage(imgObj,make_number(),make_number(),make_number(),make_number(),make_number(),make_number(),make_number(),make_number());
                 break;
 
@@ -325,17 +352,17 @@ static void do_fuzz(SkCanvas* canvas)
             break;
 
             case 24:
-                if (quick == true) break;
+                if (fQuick == true) break;
                 //ctx.arc(make_number(),make_number(),make_number(),make_number(),make_number(),true);
                 break;
 
             case 25:
-                if (quick == true) break;
+                if (fQuick == true) break;
                 //ctx.arcTo(make_number(),make_number(),make_number(),make_number(),make_number());
                 break;
 
             case 26:
-                if (quick == true) break;
+                if (fQuick == true) break;
                 //ctx.bezierCurveTo(make_number(),make_number(),make_number(),make_number(),make_number(),make_number());
                 break;
 
@@ -348,13 +375,13 @@ static void do_fuzz(SkCanvas* canvas)
                 break;
 
             case 29:
-                if (quick == true) break;
+                if (fQuick == true) break;
                 path.quadTo(make_number(),make_number(),make_number(),make_number());
                 break;
 
             case 30:
                 {
-                if (quick == true) break;
+                if (fQuick == true) break;
                 SkMatrix matrix;
                 set2x3(&matrix, make_number(),make_number(),make_number(),make_number(),make_number(),make_number());
                 canvas->concat(matrix);
@@ -363,7 +390,7 @@ static void do_fuzz(SkCanvas* canvas)
 
             case 31:
                 {
-                if (quick == true) break;
+                if (fQuick == true) break;
                 SkMatrix matrix;
                 set2x3(&matrix, make_number(),make_number(),make_number(),make_number(),make_number(),make_number());
                 canvas->setMatrix(matrix);
@@ -372,23 +399,23 @@ static void do_fuzz(SkCanvas* canvas)
 
             case 32:
 
-                if (scale_large == true)
+                if (fScaleLarge == true)
                     {
 
-                    switch (scval)
+                    switch (fScval)
                         {
                         case 0:
                             canvas->scale(-1000000000,1);
                             canvas->scale(-1000000000,1);
-                            scval = 1;
+                            fScval = 1;
                             break;
                         case 1:
                             canvas->scale(-.000000001f,1);
-                            scval = 2;
+                            fScval = 2;
                             break;
                         case 2:
                             canvas->scale(-.000000001f,1);
-                            scval = 0;
+                            fScval = 0;
                             break;
                         }
 
@@ -432,11 +459,13 @@ class FuzzView : public SampleView
 
         virtual void onDrawContent(SkCanvas* canvas)
             {
-            do_fuzz(canvas);
+            fFuzzer.do_fuzz(canvas);
             this->inval(NULL);
             }
 
     private:
+        Fuzzer fFuzzer;
+
         typedef SkView INHERITED;
     };
 
@@ -30,8 +30,6 @@
 #include "SkColorPriv.h"
 #include "SkImageDecoder.h"
 
-static SkRandom gRand;
-
 static void test_chromium_9005()
     {
     SkBitmap bm;
@@ -48,12 +46,13 @@ static void test_chromium_9005()
     canvas.drawLine(pt0.fX, pt0.fY, pt1.fX, pt1.fY, paint);
     }
 
-static void generate_pts(SkPoint pts[], int count, int w, int h)
+static void generate_pts(SkRandom& rand, SkPoint pts[], int count,
+                         int w, int h)
     {
     for (int i = 0; i < count; i++)
         {
-        pts[i].set(gRand.nextUScalar1() * 3 * w - SkIntToScalar(w),
-                   gRand.nextUScalar1() * 3 * h - SkIntToScalar(h));
+        pts[i].set(rand.nextUScalar1() * 3 * w - SkIntToScalar(w),
+                   rand.nextUScalar1() * 3 * h - SkIntToScalar(h));
         }
     }
 
@@ -103,13 +102,13 @@ static bool check_bitmap_margin(const SkBitmap& bm, int margin)
 #define MARGIN  10
 
 static void line_proc(SkCanvas* canvas, const SkPaint& paint,
-                      const SkBitmap& bm)
+                      const SkBitmap& bm, SkRandom& rand)
     {
     const int N = 2;
     SkPoint pts[N];
     for (int i = 0; i < 400; i++)
         {
-        generate_pts(pts, N, WIDTH, HEIGHT);
+        generate_pts(rand, pts, N, WIDTH, HEIGHT);
 
         canvas->drawLine(pts[0].fX, pts[0].fY, pts[1].fX, pts[1].fY, paint);
         if (!check_bitmap_margin(bm, MARGIN))
@@ -122,13 +121,13 @@ static void line_proc(SkCanvas* canvas, const SkPaint& paint,
     }
 
 static void poly_proc(SkCanvas* canvas, const SkPaint& paint,
-                      const SkBitmap& bm)
+                      const SkBitmap& bm, SkRandom& rand)
     {
     const int N = 8;
     SkPoint pts[N];
     for (int i = 0; i < 50; i++)
         {
-        generate_pts(pts, N, WIDTH, HEIGHT);
+        generate_pts(rand, pts, N, WIDTH, HEIGHT);
 
         SkPath path;
         path.moveTo(pts[0]);
@@ -149,13 +148,13 @@ static SkPoint ave(const SkPoint& a, const SkPoint& b)
     }
 
 static void quad_proc(SkCanvas* canvas, const SkPaint& paint,
-                      const SkBitmap& bm)
+                      const SkBitmap& bm, SkRandom& rand)
     {
     const int N = 30;
     SkPoint pts[N];
     for (int i = 0; i < 10; i++)
         {
-        generate_pts(pts, N, WIDTH, HEIGHT);
+        generate_pts(rand, pts, N, WIDTH, HEIGHT);
 
         SkPath path;
         path.moveTo(pts[0]);
@@ -177,13 +176,13 @@ static void add_cubic(SkPath* path, const SkPoint& mid, const SkPoint& end)
     }
 
 static void cube_proc(SkCanvas* canvas, const SkPaint& paint,
-                      const SkBitmap& bm)
+                      const SkBitmap& bm, SkRandom& rand)
     {
     const int N = 30;
     SkPoint pts[N];
     for (int i = 0; i < 10; i++)
         {
-        generate_pts(pts, N, WIDTH, HEIGHT);
+        generate_pts(rand, pts, N, WIDTH, HEIGHT);
 
         SkPath path;
         path.moveTo(pts[0]);
@@ -197,7 +196,8 @@ static void cube_proc(SkCanvas* canvas, const SkPaint& paint,
         }
     }
 
-typedef void (*HairProc)(SkCanvas*, const SkPaint&, const SkBitmap&);
+typedef void (*HairProc)(SkCanvas*, const SkPaint&, const SkBitmap&,
+                         SkRandom&);
 
 static const struct
     {
@@ -221,6 +221,8 @@ class HairlineView : public SampleView
         SkMSec fNow;
         int fProcIndex;
         bool fDoAA;
+        // each view its own sequence, views may draw on different threads
+        SkRandom fRand;
     public:
         HairlineView()
             {
@@ -255,7 +257,7 @@ class HairlineView : public SampleView
 
         virtual void onDrawContent(SkCanvas* canvas)
             {
-            gRand.setSeed(fNow);
+            fRand.setSeed(fNow);
 
             if (false)
                 {
@@ -280,7 +282,7 @@ class HairlineView : public SampleView
             paint.setStyle(SkPaint::kStroke_Style);
 
             bm2.eraseColor(0);
-            gProcs[fProcIndex].fProc(&c2, paint, bm);
+            gProcs[fProcIndex].fProc(&c2, paint, bm, fRand);
             canvas->drawBitmap(bm2, SkIntToScalar(10), SkIntToScalar(10), NULL);
 
             SkMSec now = SampleCode::GetAnimTime();
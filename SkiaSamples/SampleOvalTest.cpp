@@ -19,10 +19,14 @@ class OvalTestView : public SampleView
         SkPMColor   fInsideColor;   // signals an interior pixel that was not set
         SkPMColor   fOutsideColor;  // signals an exterior pixels that was set
         SkBitmap    fBitmap;
+        int         fFlatCount;     // totals over the sizes drawn so far
+        int         fBuldgeCount;
 
         OvalTestView()
             {
             fSize.set(SK_Scalar1, SK_Scalar1);
+            fFlatCount = 0;
+            fBuldgeCount = 0;
 
             fBitmap.setConfig(SkBitmap::kARGB_8888_Config, kILimit, kILimit);
             fBitmap.allocPixels();
@@ -98,15 +102,13 @@ class OvalTestView : public SampleView
             canvas->drawBitmap(fBitmap, SkIntToScalar(20), SkIntToScalar(20), NULL);
 
 
-            static int gFlatCount;
-            static int gBuldgeCount;
-            gFlatCount += flatCount;
-            gBuldgeCount += buldgeCount;
+            fFlatCount += flatCount;
+            fBuldgeCount += buldgeCount;
 
             if (fSize.fWidth < kLimit)
                 {
                 SkDebugf("--- width=%g, flat=%d buldge=%d total: flat=%d buldge=%d\n", fSize.fWidth,
-                         flatCount, buldgeCount, gFlatCount, gBuldgeCount);
+                         flatCount, buldgeCount, fFlatCount, fBuldgeCount);
                 fSize.fWidth += SK_Scalar1;
                 fSize.fHeight += SK_Scalar1;
                 }
@@ -21,14 +21,13 @@
 #include "SkPixelXorXfermode.h"
 
 #define CORNER_RADIUS   12
-static SkScalar gPhase;
 
 static const int gXY[] =
     {
     4, 0, 0, -4, 8, -4, 12, 0, 8, 4, 0, 4
     };
 
-static SkPathEffect* make_pe(int flags)
+static SkPathEffect* make_pe(int flags, SkScalar phase)
     {
     if (flags == 1)
         return new SkCornerPathEffect(SkIntToScalar(CORNER_RADIUS));
@@ -40,7 +39,7 @@ static SkPathEffect* make_pe(int flags)
     path.close();
     path.offset(SkIntToScalar(-6), 0);
 
-    SkPathEffect* outer = new SkPath1DPathEffect(path, SkIntToScalar(12), gPhase, SkPath1DPathEffect::kRotate_Style);
+    SkPathEffect* outer = new SkPath1DPathEffect(path, SkIntToScalar(12), phase, SkPath1DPathEffect::kRotate_Style);
 
     if (flags == 2)
         return outer;
@@ -53,7 +52,7 @@ static SkPathEffect* make_pe(int flags)
     return pe;
     }
 
-static SkPathEffect* make_warp_pe()
+static SkPathEffect* make_warp_pe(SkScalar phase)
     {
     SkPath  path;
     path.moveTo(SkIntToScalar(gXY[0]), SkIntToScalar(gXY[1]));
@@ -62,7 +61,7 @@ static SkPathEffect* make_warp_pe()
     path.close();
     path.offset(SkIntToScalar(-6), 0);
 
-    SkPathEffect* outer = new SkPath1DPathEffect(path, SkIntToScalar(12), gPhase, SkPath1DPathEffect::kMorph_Style);
+    SkPathEffect* outer = new SkPath1DPathEffect(path, SkIntToScalar(12), phase, SkPath1DPathEffect::kMorph_Style);
     SkPathEffect* inner = new SkCornerPathEffect(SkIntToScalar(CORNER_RADIUS));
 
     SkPathEffect* pe = new SkComposePathEffect(outer, inner);
@@ -106,9 +105,12 @@ class PathEffectView : public SampleView
     {
         SkPath  fPath;
         SkPoint fClickPt;
+        SkScalar fPhase;
     public:
         PathEffectView()
             {
+            fPhase = 0;
+
             SkRandom    rand;
             int         steps = 20;
             SkScalar    dist = SkIntToScalar(400);
@@ -157,7 +159,7 @@ class PathEffectView : public SampleView
 
         virtual void onDrawContent(SkCanvas* canvas)
             {
-            gPhase -= SampleCode::GetAnimSecondsDelta() * 40;
+            fPhase -= SampleCode::GetAnimSecondsDelta() * 40;
             this->inval(NULL);
 
             SkPaint paint;
@@ -170,26 +172,26 @@ class PathEffectView : public SampleView
             paint.setStrokeWidth(0);
 
             paint.setColor(SK_ColorWHITE);
-            paint.setPathEffect(make_pe(1))->unref();
+            paint.setPathEffect(make_pe(1, fPhase))->unref();
             canvas->drawPath(fPath, paint);
 #endif
 
             canvas->translate(0, SkIntToScalar(50));
 
             paint.setColor(SK_ColorBLUE);
-            paint.setPathEffect(make_pe(2))->unref();
+            paint.setPathEffect(make_pe(2, fPhase))->unref();
             canvas->drawPath(fPath, paint);
 
             canvas->translate(0, SkIntToScalar(50));
 
             paint.setARGB(0xFF, 0, 0xBB, 0);
-            paint.setPathEffect(make_pe(3))->unref();
+            paint.setPathEffect(make_pe(3, fPhase))->unref();
             canvas->drawPath(fPath, paint);
 
             canvas->translate(0, SkIntToScalar(50));
 
             paint.setARGB(0xFF, 0, 0, 0);
-            paint.setPathEffect(make_warp_pe())->unref();
+            paint.setPathEffect(make_warp_pe(fPhase))->unref();
             paint.setRasterizer(new testrast)->unref();
             canvas->drawPath(fPath, paint);
             }
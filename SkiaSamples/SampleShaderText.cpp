@@ -36,15 +36,14 @@ static void makebm(SkBitmap* bm, SkBitmap::Config config, int w, int h)
     canvas.drawPaint(paint);
     }
 
-SkShader* MakeBitmapShader(SkShader::TileMode tx, SkShader::TileMode ty,
-                           int w, int h)
+static SkShader* MakeBitmapShader(SkBitmap* bmp, SkShader::TileMode tx,
+                                  SkShader::TileMode ty, int w, int h)
     {
-    static SkBitmap bmp;
-    if (bmp.isNull())
+    if (bmp->isNull())
         {
-        makebm(&bmp, SkBitmap::kARGB_8888_Config, w/2, h/4);
+        makebm(bmp, SkBitmap::kARGB_8888_Config, w/2, h/4);
         }
-    return SkShader::CreateBitmapShader(bmp, tx, ty);
+    return SkShader::CreateBitmapShader(*bmp, tx, ty);
     }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -119,6 +118,8 @@ static const GradMaker gGradMakers[] =
 
 class ShaderTextView : public SampleView
     {
+        // made on the first draw, each view its own
+        SkBitmap fBitmap;
     public:
         ShaderTextView()
             {
@@ -181,7 +182,8 @@ class ShaderTextView : public SampleView
                 {
                 for (size_t ty = 0; ty < SK_ARRAY_COUNT(tileModes); ++ty)
                     {
-                    shaders[shdIdx++] = MakeBitmapShader(tileModes[tx],
+                    shaders[shdIdx++] = MakeBitmapShader(&fBitmap,
+                                                         tileModes[tx],
                                                          tileModes[ty],
                                                          w/8, h);
                     }
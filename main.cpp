@@ -47,6 +47,7 @@
 #include <GLES/gl.h>
 
 #include "SkiWin.h"
+#include "SkiWinEventPump.h"
 
 using namespace android;
 
@@ -107,9 +108,15 @@ private:
 /////////////// SkEvent impl //////////////
 ///////////////////////////////////////////
 
-void SkEvent::SignalQueueTimer(SkMSec) {}
+void SkEvent::SignalQueueTimer(SkMSec delay)
+    {
+    SkiWinEventPump::get()->signalQueueTimer(delay);
+    }
 
-void SkEvent::SignalNonEmptyQueue() {}
+void SkEvent::SignalNonEmptyQueue()
+    {
+    SkiWinEventPump::get()->signalNonEmptyQueue();
+    }
 
 ///////////////////////////////////////////
 ///////////// SkOSWindow impl /////////////
@@ -118,13 +125,32 @@ void SkEvent::SignalNonEmptyQueue() {}
 void SkOSWindow::onSetTitle(const char title[])
     {
     printf("View Title %s\n", title);
+
+    if (gSkiWin)
+        gSkiWin->invalidateTitle(this);
     }
 
 void SkOSWindow::onHandleInval(const SkIRect& rect)
     {
+    if (gSkiWin)
+        gSkiWin->invalidateWindow(this, rect);
     }
 
 
+/*
+ * Moves the pixels of the window within r along with those shown for it,
+ * SampleWindow::scroll() then only draws the exposed part.
+ */
+
+bool SkiWinScrollWindow(SkOSWindow* window, int dx, int dy,
+                        const SkIRect& r, SkRegion* exposed)
+    {
+    if (gSkiWin == NULL)
+        return false;
+
+    return gSkiWin->scrollWindow(window, dx, dy, r, exposed);
+    }
+
 void SkOSWindow::onPDFSaved(const char title[], const char desc[],
                             const char path[])
     {
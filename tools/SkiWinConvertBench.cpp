@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * skiwin-convertbench - Time 8888 to 565 conversion of a SampleWindow sized
+ * bitmap, SkiWinConvert8888To565() against SkCanvas::drawBitmap().
+ *
+ * skiwin-convertbench [-w width] [-h height] [-n iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <utils/Timers.h>
+
+#include <core/SkBitmap.h>
+#include <core/SkCanvas.h>
+#include <core/SkColorPriv.h>
+#include <core/SkPaint.h>
+
+#include "SkiWinPixelConvert.h"
+
+using namespace android;
+
+enum
+    {
+    BENCH_DRAW_BITMAP,
+    BENCH_DRAW_BITMAP_DITHER,
+    BENCH_CONVERT,
+    BENCH_CONVERT_DITHER,
+    BENCH_COUNT
+    };
+
+static const char* gBenchNames[BENCH_COUNT] =
+    {
+    "drawBitmap",
+    "drawBitmap dither",
+    "convert",
+    "convert dither"
+    };
+
+static void usage(const char* name)
+    {
+    fprintf(stderr, "usage: %s [-w width] [-h height] [-n iterations]\n",
+            name);
+    }
+
+static void runOnce(int bench, const SkBitmap& src, SkBitmap* dst,
+                    SkCanvas* canvas)
+    {
+    switch (bench)
+        {
+        case BENCH_DRAW_BITMAP:
+        case BENCH_DRAW_BITMAP_DITHER:
+            {
+            SkPaint paint;
+
+            paint.setDither(bench == BENCH_DRAW_BITMAP_DITHER);
+            canvas->drawBitmap(src, 0, 0, &paint);
+            break;
+            }
+        case BENCH_CONVERT:
+        case BENCH_CONVERT_DITHER:
+            SkiWinConvert8888To565(dst->getPixels(), dst->rowBytes(),
+                                   src.getPixels(), src.rowBytes(),
+                                   src.width(), src.height(), 0, 0,
+                                   bench == BENCH_CONVERT_DITHER);
+            break;
+        }
+    }
+
+int main(int argc, char** argv)
+    {
+    int width = 320;
+    int height = 150;
+    int iterations = 1000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "w:h:n:")) != -1)
+        {
+        switch (opt)
+            {
+            case 'w':
+                width = atoi(optarg);
+                break;
+            case 'h':
+                height = atoi(optarg);
+                break;
+            case 'n':
+                iterations = atoi(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+            }
+        }
+
+    if (width <= 0 || height <= 0 || iterations <= 0)
+        {
+        usage(argv[0]);
+        return 1;
+        }
+
+    SkBitmap src;
+    SkBitmap dst;
+    SkBitmap ref;
+
+    src.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+    src.allocPixels();
+    src.setIsOpaque(true);
+
+    dst.setConfig(SkBitmap::kRGB_565_Config, width, height);
+    dst.allocPixels();
+
+    ref.setConfig(SkBitmap::kRGB_565_Config, width, height);
+    ref.allocPixels();
+
+    // opaque noise, so nothing can take a shortcut on runs of equal pixels
+    srand(1);
+
+    for (int y = 0; y < height; y++)
+        {
+        uint32_t* row = src.getAddr32(0, y);
+
+        for (int x = 0; x < width; x++)
+            row[x] = SkPackARGB32(0xff, rand() & 0xff, rand() & 0xff,
+                                  rand() & 0xff);
+        }
+
+    // without dither both paths must truncate to the same pixels
+    SkCanvas refCanvas(ref);
+
+    runOnce(BENCH_DRAW_BITMAP, src, &ref, &refCanvas);
+    runOnce(BENCH_CONVERT, src, &dst, NULL);
+
+    for (int y = 0; y < height; y++)
+        {
+        if (memcmp(ref.getAddr16(0, y), dst.getAddr16(0, y), width * 2))
+            {
+            fprintf(stderr, "convert differs from drawBitmap in row %d\n", y);
+            return 1;
+            }
+        }
+
+    printf("%dx%d, %d iterations, %s\n", width, height, iterations,
+           SkiWinPixelConvertImpl());
+
+    SkCanvas canvas(dst);
+
+    for (int bench = 0; bench < BENCH_COUNT; bench++)
+        {
+        // warm up caches and any lazily built blitter state
+        runOnce(bench, src, &dst, &canvas);
+
+        nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+
+        for (int i = 0; i < iterations; i++)
+            runOnce(bench, src, &dst, &canvas);
+
+        nsecs_t elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+        double perFrame = double(elapsed) / iterations / 1000.0;
+
+        printf("%-20s %9.1f us/frame %9.1f Mpixel/s\n", gBenchNames[bench],
+               perFrame, double(width) * height / perFrame);
+        }
+
+    return 0;
+    }
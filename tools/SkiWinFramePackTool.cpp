@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2007 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * skiwin-framepack - Build a SkiWin frame pack from a numbered PNG sequence.
+ *
+ * skiwin-framepack [-f 565|8888] [-e raw|rle] [-i interval_ms] pattern output
+ *
+ * e.g. skiwin-framepack /data/screenvideo/screen-%d.png \
+ *                       /data/screenvideo/screen.pack
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <utils/String8.h>
+
+#include <core/SkBitmap.h>
+#include <images/SkImageDecoder.h>
+
+#include "SkiWinFramePack.h"
+
+using namespace android;
+
+static void usage(const char* name)
+    {
+    fprintf(stderr, "usage: %s [-f 565|8888] [-e raw|rle] [-i interval_ms] "
+            "pattern output\n", name);
+    }
+
+int main(int argc, char** argv)
+    {
+    SkBitmap::Config config = SkBitmap::kRGB_565_Config;
+    uint32_t encoding = SKIWIN_FRAMEPACK_RLE;
+    uint32_t interval = 100;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:e:i:")) != -1)
+        {
+        switch (opt)
+            {
+            case 'f':
+                if (!strcmp(optarg, "565"))
+                    config = SkBitmap::kRGB_565_Config;
+                else if (!strcmp(optarg, "8888"))
+                    config = SkBitmap::kARGB_8888_Config;
+                else
+                    {
+                    usage(argv[0]);
+                    return 1;
+                    }
+                break;
+            case 'e':
+                if (!strcmp(optarg, "raw"))
+                    encoding = SKIWIN_FRAMEPACK_RAW;
+                else if (!strcmp(optarg, "rle"))
+                    encoding = SKIWIN_FRAMEPACK_RLE;
+                else
+                    {
+                    usage(argv[0]);
+                    return 1;
+                    }
+                break;
+            case 'i':
+                interval = atoi(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+            }
+        }
+
+    if (argc - optind != 2 || interval == 0)
+        {
+        usage(argv[0]);
+        return 1;
+        }
+
+    const char* pattern = argv[optind];
+    const char* output = argv[optind + 1];
+    struct stat st;
+    int count = 0;
+
+    // the sequence ends at the first missing file, just like playback
+    while (stat(String8::format(pattern, count).string(), &st) == 0)
+        count++;
+
+    if (count == 0)
+        {
+        fprintf(stderr, "no frames match '%s'\n", pattern);
+        return 1;
+        }
+
+    SkiWinFramePackWriter writer;
+    status_t err = NO_ERROR;
+
+    for (int i = 0; i < count && err == NO_ERROR; i++)
+        {
+        String8 name = String8::format(pattern, i);
+        SkBitmap bitmap;
+
+        if (!SkImageDecoder::DecodeFile(name.string(), &bitmap))
+            {
+            fprintf(stderr, "could not decode '%s'\n", name.string());
+            return 1;
+            }
+
+        if (i == 0)
+            {
+            err = writer.begin(output, bitmap.width(), bitmap.height(),
+                               config, count, interval * 1000);
+            if (err != NO_ERROR)
+                break;
+            }
+
+        err = writer.addFrame(bitmap, encoding);
+        }
+
+    if (err == NO_ERROR)
+        err = writer.finish();
+
+    if (err != NO_ERROR)
+        {
+        fprintf(stderr, "writing '%s' failed: %s\n", output, strerror(-err));
+        return 1;
+        }
+
+    if (stat(output, &st) == 0)
+        printf("%d frames, %lld bytes\n", count, (long long)st.st_size);
+
+    return 0;
+    }